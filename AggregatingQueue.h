@@ -0,0 +1,98 @@
+//
+//  AggregatingQueue.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+/**
+ A FIFO Queue in Objective-C that keeps a running aggregate of its contents, for sliding windows
+ 
+ @discussion The queue is built from two stacks. New objects go on the back stack, which tracks the aggregate of everything on it. When the front stack runs dry, the back stack is moved over in one pass, and each object on the front stack records the aggregate of itself and everything behind it. The aggregate of the whole queue is then the front stack's top aggregate combined with the back stack's, so enqueueing, dequeueing and reading the aggregate are all O(1) amortized, for any associative combine block, even one that isn't commutative or invertible, like min, max or gcd.
+ */
+@interface AggregatingQueue<__covariant ObjectType> : NSObject
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @name Factory Methods
+ */
+
+/**
+ Create an empty queue
+ 
+ @param combine An associative block that combines two aggregates, where the older one is always passed first. An object on its own is its own aggregate.
+ @return The queue
+ */
++ (instancetype)queueWithCombineBlock:(ObjectType (^)(ObjectType older, ObjectType newer))combine;
+
+/**
+ @name Initializers
+ */
+
+/**
+ Create an empty queue
+ 
+ @param combine An associative block that combines two aggregates, where the older one is always passed first. An object on its own is its own aggregate.
+ @return The queue
+ */
+- (instancetype)initWithCombineBlock:(ObjectType (^)(ObjectType older, ObjectType newer))combine NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ @name Enqueue, Peek, Dequeue
+ */
+
+/**
+ Enqueue an object, in O(1)
+ 
+ @param object The object
+ */
+- (void)enqueue:(ObjectType)object;
+
+/**
+ Enqueue objects, in order
+ 
+ @param objects The objects
+ */
+- (void)enqueueObjects:(NSArray<ObjectType> *)objects;
+
+/**
+ View the item at the front of the queue
+ 
+ @return The item at the front of the queue
+ */
+- (nullable ObjectType)peek;
+
+/**
+ Dequeue an item from the front of the queue, in O(1) amortized
+ 
+ @return The item
+ */
+- (nullable ObjectType)dequeue;
+
+/**
+ @name Aggregates
+ */
+
+/**
+ Every object in the queue combined, front to back, or nil if the queue is empty
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly, nullable) ObjectType aggregate;
+
+/**
+ @name Content Checking
+ */
+
+/**
+ The number of items in the queue
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+NS_ASSUME_NONNULL_END
+
+@end
@@ -0,0 +1,172 @@
+//
+//  AggregatingQueue.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "AggregatingQueue.h"
+#import "SQContiguousBuffer.h"
+
+@implementation AggregatingQueue {
+    
+    id (^_combine)(id older, id newer);
+    
+    // The oldest objects, with the oldest on top, each alongside the aggregate of itself and every newer object on the front stack
+    SQContiguousBuffer _front;
+    SQContiguousBuffer _frontAggregates;
+    
+    // The newest objects, with the newest on top, and the aggregate of all of them
+    SQContiguousBuffer _back;
+    id _backAggregate;
+    
+}
+
+#pragma mark - Public Class Methods
+
++ (instancetype)queueWithCombineBlock:(id (^)(id, id))combine {
+    
+    return [[self alloc] initWithCombineBlock:combine];
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (void)dealloc {
+    
+    SQContiguousBufferDestroy(&_front);
+    SQContiguousBufferDestroy(&_frontAggregates);
+    SQContiguousBufferDestroy(&_back);
+    
+}
+
+- (NSString *)description {
+    
+    return [NSString stringWithFormat:@"<%@: %p; count = %lu; aggregate = %@>", NSStringFromClass([self class]), self, (unsigned long)self.count, self.aggregate];
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (NSUInteger)count {
+    
+    return _front.count + _back.count;
+    
+}
+
+- (id)aggregate {
+    
+    if (_frontAggregates.count == 0) {
+        
+        return _backAggregate;
+        
+    }
+    
+    id frontAggregate = (__bridge id)_frontAggregates.objects[_frontAggregates.count - 1];
+    
+    return _back.count > 0 ? _combine(frontAggregate, _backAggregate) : frontAggregate;
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithCombineBlock:(id (^)(id, id))combine {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _combine = [combine copy];
+        SQContiguousBufferInit(&_front, 0);
+        SQContiguousBufferInit(&_frontAggregates, 0);
+        SQContiguousBufferInit(&_back, 0);
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Enqueue Peek Dequeue
+
+- (void)enqueue:(id)object {
+    
+    SQContiguousBufferAppend(&_back, object);
+    _backAggregate = _back.count > 1 ? _combine(_backAggregate, object) : object;
+    
+}
+
+- (void)enqueueObjects:(NSArray *)objects {
+    
+    for (id object in objects) {
+        
+        [self enqueue:object];
+        
+    }
+    
+}
+
+- (id)peek {
+    
+    if (_front.count > 0) {
+        
+        return (__bridge id)_front.objects[_front.count - 1];
+        
+    }
+    
+    return _back.count > 0 ? (__bridge id)_back.objects[0] : nil;
+    
+}
+
+- (id)dequeue {
+    
+    if (_front.count == 0) {
+        
+        if (_back.count == 0) {
+            
+            return nil;
+            
+        }
+        
+        [self transferBackToFront];
+        
+    }
+    
+    SQContiguousBufferTruncate(&_frontAggregates, _frontAggregates.count - 1);
+    
+    return SQContiguousBufferRemoveLast(&_front);
+    
+}
+
+#pragma mark - Private Instance Methods
+
+/**
+ Move every object from the back stack to the front stack, newest first, so the oldest ends up on top
+ */
+- (void)transferBackToFront {
+    
+    SQContiguousBufferReserve(&_front, _back.count);
+    SQContiguousBufferReserve(&_frontAggregates, _back.count);
+    
+    id aggregate = nil;
+    
+    for (NSUInteger i = _back.count; i > 0; i--) {
+        
+        id object = (__bridge id)_back.objects[i - 1];
+        aggregate = aggregate ? _combine(object, aggregate) : object;
+        
+        // The reference moves from the back stack to the front stack
+        _front.objects[_front.count++] = _back.objects[i - 1];
+        SQContiguousBufferAppend(&_frontAggregates, aggregate);
+        
+    }
+    
+    _front.mutations++;
+    _back.count = 0;
+    _back.mutations++;
+    _backAggregate = nil;
+    
+}
+
+@end
@@ -0,0 +1,108 @@
+//
+//  AggregatingStack.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+/**
+ A LIFO Stack in Objective-C that always knows its smallest and largest objects
+ 
+ @discussion Alongside the objects, the stack keeps two monotonic stacks: one of every object that was the minimum when it was pushed, and one of every object that was the maximum. Pushing and popping update them in O(1), so -min and -max are O(1) reads rather than a scan or a sort.
+ */
+@interface AggregatingStack<__covariant ObjectType> : NSObject<NSFastEnumeration>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @name Factory Methods
+ */
+
+/**
+ Create an empty stack that orders objects with -compare:
+ 
+ @return The stack
+ */
++ (instancetype)stack;
+
+/**
+ Create an empty stack that orders objects with a comparator
+ 
+ @param comparator The comparator
+ @return The stack
+ */
++ (instancetype)stackWithComparator:(NSComparator)comparator;
+
+/**
+ @name Initializers
+ */
+
+/**
+ Create an empty stack that orders objects with a comparator
+ 
+ @param comparator The comparator
+ @return The stack
+ */
+- (instancetype)initWithComparator:(NSComparator)comparator NS_DESIGNATED_INITIALIZER;
+
+/**
+ @name Push, Peek, Pop
+ */
+
+/**
+ Add an object to the top of the stack, in O(1)
+ 
+ @param object The object
+ */
+- (void)push:(ObjectType)object;
+
+/**
+ Add objects to the top of the stack, in order
+ 
+ @param objects The objects
+ */
+- (void)pushObjects:(NSArray<ObjectType> *)objects;
+
+/**
+ View the item at the top of the stack
+ 
+ @return The item at the top of the stack
+ */
+- (nullable ObjectType)peek;
+
+/**
+ Remove the item from the top of the stack and return it, in O(1)
+ 
+ @return The item formerly at the top of the stack
+ */
+- (nullable ObjectType)pop;
+
+/**
+ @name Aggregates
+ */
+
+/**
+ The smallest object in the stack, or nil if it's empty. If several objects compare equal, the one pushed first.
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly, nullable) ObjectType min;
+
+/**
+ The largest object in the stack, or nil if it's empty. If several objects compare equal, the one pushed first.
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly, nullable) ObjectType max;
+
+/**
+ @name Content Checking
+ */
+
+/**
+ The number of items in the stack
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+NS_ASSUME_NONNULL_END
+
+@end
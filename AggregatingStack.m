@@ -0,0 +1,176 @@
+//
+//  AggregatingStack.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "AggregatingStack.h"
+#import "SQContiguousBuffer.h"
+
+@implementation AggregatingStack {
+    
+    NSComparator _comparator;
+    SQContiguousBuffer _objects;
+    
+    // Every object that was no greater (or no less) than the minimum (or maximum) when it was pushed, so the top is always the current one
+    SQContiguousBuffer _minimums;
+    SQContiguousBuffer _maximums;
+    
+}
+
+#pragma mark - Public Class Methods
+
++ (instancetype)stack {
+    
+    return [[self alloc] init];
+    
+}
+
++ (instancetype)stackWithComparator:(NSComparator)comparator {
+    
+    return [[self alloc] initWithComparator:comparator];
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (instancetype)init {
+    
+    self = [self initWithComparator:^NSComparisonResult(id obj1, id obj2) {
+        
+        return [obj1 compare:obj2];
+        
+    }];
+    
+    return self;
+    
+}
+
+- (void)dealloc {
+    
+    SQContiguousBufferDestroy(&_objects);
+    SQContiguousBufferDestroy(&_minimums);
+    SQContiguousBufferDestroy(&_maximums);
+    
+}
+
+- (NSString *)description {
+    
+    return SQContiguousBufferCopyArray(&_objects).description;
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (NSUInteger)count {
+    
+    return _objects.count;
+    
+}
+
+- (id)min {
+    
+    return _minimums.count > 0 ? (__bridge id)_minimums.objects[_minimums.count - 1] : nil;
+    
+}
+
+- (id)max {
+    
+    return _maximums.count > 0 ? (__bridge id)_maximums.objects[_maximums.count - 1] : nil;
+    
+}
+
+#pragma mark - NSFastEnumeration
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id  _Nullable __unsafe_unretained [])buffer count:(NSUInteger)len {
+    
+    return SQContiguousBufferEnumerate(&_objects, state);
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithComparator:(NSComparator)comparator {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _comparator = [comparator copy];
+        SQContiguousBufferInit(&_objects, 0);
+        SQContiguousBufferInit(&_minimums, 0);
+        SQContiguousBufferInit(&_maximums, 0);
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Push Peek Pop
+
+- (void)push:(id)object {
+    
+    SQContiguousBufferAppend(&_objects, object);
+    
+    // Ties are pushed too, so popping one of several equal extremes leaves the others in place
+    if (_minimums.count == 0 || _comparator(object, self.min) != NSOrderedDescending) {
+        
+        SQContiguousBufferAppend(&_minimums, object);
+        
+    }
+    
+    if (_maximums.count == 0 || _comparator(object, self.max) != NSOrderedAscending) {
+        
+        SQContiguousBufferAppend(&_maximums, object);
+        
+    }
+    
+}
+
+- (void)pushObjects:(NSArray *)objects {
+    
+    for (id object in objects) {
+        
+        [self push:object];
+        
+    }
+    
+}
+
+- (id)peek {
+    
+    return _objects.count > 0 ? (__bridge id)_objects.objects[_objects.count - 1] : nil;
+    
+}
+
+- (id)pop {
+    
+    id object = SQContiguousBufferRemoveLast(&_objects);
+    
+    if (!object) {
+        
+        return nil;
+        
+    }
+    
+    // An object is only on an auxiliary stack if it went on when it was pushed, so compare by identity
+    if (_minimums.count > 0 && (__bridge id)_minimums.objects[_minimums.count - 1] == object) {
+        
+        SQContiguousBufferTruncate(&_minimums, _minimums.count - 1);
+        
+    }
+    
+    if (_maximums.count > 0 && (__bridge id)_maximums.objects[_maximums.count - 1] == object) {
+        
+        SQContiguousBufferTruncate(&_maximums, _maximums.count - 1);
+        
+    }
+    
+    return object;
+    
+}
+
+@end
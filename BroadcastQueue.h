@@ -0,0 +1,187 @@
+//
+//  BroadcastQueue.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+@class BroadcastConsumer<ObjectType>;
+
+/**
+ A bounded, thread-safe FIFO Queue in Objective-C where every consumer sees every object
+ 
+ @discussion Objects are published into a single preallocated ring, and each consumer reads the ring through its own cursor, so an object is stored once no matter how many consumers see it. The producer is gated by the slowest consumer: an object is only overwritten once every consumer has read past it, and enqueueing blocks while the ring is full. A consumer only sees objects enqueued after it was added. Objects stay in the ring until their slot is reused or the queue is deallocated.
+ */
+@interface BroadcastQueue<__covariant ObjectType> : NSObject
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @name Factory Methods
+ */
+
+/**
+ Create an empty broadcast queue with room for 1024 objects
+ 
+ @return The broadcast queue
+ */
++ (instancetype)queue;
+
+/**
+ Create an empty broadcast queue
+ 
+ @param capacity The number of objects the ring has room for, rounded up to a power of two. Must be positive.
+ @return The broadcast queue
+ */
++ (instancetype)queueWithCapacity:(NSUInteger)capacity;
+
+/**
+ @name Initializers
+ */
+
+/**
+ Create an empty broadcast queue
+ 
+ @param capacity The number of objects the ring has room for, rounded up to a power of two. Must be positive.
+ @return The broadcast queue
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+/**
+ @name Consumers
+ */
+
+/**
+ Add a consumer, which sees every object enqueued from now on. Safe to call from any thread.
+ 
+ @note Until it is removed or deallocated, the consumer gates the producer, so a consumer that stops reading eventually stops the queue
+ @return The consumer
+ */
+- (BroadcastConsumer<ObjectType> *)addConsumer;
+
+/**
+ Remove a consumer, so that it no longer gates the producer and sees no further objects. Safe to call from any thread, but not while the consumer is in the middle of a read on another thread.
+ 
+ @param consumer The consumer
+ */
+- (void)removeConsumer:(BroadcastConsumer<ObjectType> *)consumer;
+
+/**
+ @name Enqueueing
+ */
+
+/**
+ Enqueue an object, waiting for the slowest consumer if the ring is full. Safe to call from any thread.
+ 
+ @param object The object
+ */
+- (void)enqueue:(ObjectType)object;
+
+/**
+ Enqueue an object, unless the ring is full. Safe to call from any thread.
+ 
+ @param object The object
+ @return YES if the object was enqueued, NO if the ring was full
+ */
+- (BOOL)tryEnqueue:(ObjectType)object;
+
+/**
+ Enqueue an array of objects, in order, waiting for the slowest consumer whenever the ring is full. Safe to call from any thread.
+ 
+ @note Objects from other producers may be interleaved with the array if the ring fills part way through
+ @param objects The array
+ */
+- (void)enqueueObjects:(NSArray<ObjectType> *)objects;
+
+/**
+ @name Content Checking
+ */
+
+/**
+ The number of objects the ring has room for
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger capacity;
+
+/**
+ The number of consumers
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger consumerCount;
+
+/**
+ The number of objects some consumer hasn't read yet
+ 
+ @note With producers and consumers running, this is only a snapshot
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+NS_ASSUME_NONNULL_END
+
+@end
+
+/**
+ One consumer's view of a BroadcastQueue
+ 
+ @discussion Each consumer has its own cursor into the queue's ring, and reads independently of every other consumer. A consumer must only be read from one thread at a time. A consumer that is deallocated removes itself from its queue.
+ */
+@interface BroadcastConsumer<__covariant ObjectType> : NSObject
+
+NS_ASSUME_NONNULL_BEGIN
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ @name Dequeueing
+ */
+
+/**
+ Dequeue the next object, without blocking
+ 
+ @return The object, or nil if the consumer has read everything enqueued so far
+ */
+- (nullable ObjectType)dequeue;
+
+/**
+ Dequeue up to a number of objects, without blocking
+ 
+ @param maximumCount The most objects to dequeue
+ @return The objects, in order, which may be empty
+ */
+- (NSArray<ObjectType> *)dequeueUpTo:(NSUInteger)maximumCount;
+
+/**
+ Dequeue up to a number of objects, waiting for the producer if there are none yet
+ 
+ @param maximumCount The most objects to dequeue
+ @param limit The latest date to wait until
+ @return The objects, in order, or an empty array if none were enqueued before the limit
+ */
+- (NSArray<ObjectType> *)dequeueUpTo:(NSUInteger)maximumCount waitingUntilDate:(NSDate *)limit;
+
+/**
+ Read every object available to the consumer straight out of the ring, without copying them into an array, and then dequeue them all at once
+ 
+ @param block The block to call with each object. Setting stop dequeues the objects seen so far, and leaves the rest.
+ @return The number of objects dequeued
+ */
+- (NSUInteger)dequeueAvailableObjectsUsingBlock:(void (NS_NOESCAPE ^)(ObjectType object, BOOL *stop))block;
+
+/**
+ @name Content Checking
+ */
+
+/**
+ The queue the consumer reads from
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) BroadcastQueue<ObjectType> *queue;
+
+/**
+ The number of objects the consumer hasn't read yet
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+NS_ASSUME_NONNULL_END
+
+@end
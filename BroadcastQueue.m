@@ -0,0 +1,581 @@
+//
+//  BroadcastQueue.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "BroadcastQueue.h"
+
+#import <os/lock.h>
+#import <stdatomic.h>
+
+/**
+ The number of overwritten objects a producer collects before releasing them, outside the lock
+ */
+#define SQBroadcastQueueReleaseBatch 64
+
+/**
+ The ring shared by a queue and its consumers
+ */
+typedef struct SQBroadcastRing {
+    
+    // The objects, each retained once by the ring. Slot s & mask holds the object with sequence s.
+    const void **slots;
+    NSUInteger mask;
+    
+    // The sequence the next object will be published at, which is also the number of objects ever published
+    _Atomic(uint64_t) published;
+    
+} SQBroadcastRing;
+
+@interface BroadcastConsumer () {
+    
+    @public
+    
+    // The sequence of the next object this consumer will read. Only the consumer writes it.
+    _Atomic(uint64_t) _cursor;
+    
+    // Set once the consumer stops gating the producer, after which the ring is no longer safe to read
+    _Atomic(BOOL) _removed;
+    
+}
+
+- (instancetype)initWithQueue:(BroadcastQueue *)queue ring:(SQBroadcastRing *)ring;
+
+@end
+
+@interface BroadcastQueue ()
+
+- (void)unregisterCursor:(_Atomic(uint64_t) *)cursor;
+- (void)wakeWaiters;
+- (BOOL)waitUntilDate:(NSDate *)limit forCondition:(BOOL (^)(void))condition;
+
+@end
+
+@implementation BroadcastQueue {
+    
+    SQBroadcastRing _ring;
+    NSUInteger _capacity;
+    
+    // Serializes producers, and guards the cursor list
+    os_unfair_lock _producerLock;
+    _Atomic(uint64_t) **_cursors;
+    NSUInteger _cursorCount;
+    NSUInteger _cursorCapacity;
+    
+    // The slowest cursor when it was last looked at, which only ever moves forward
+    uint64_t _gate;
+    
+    // Producers waiting for room and consumers waiting for objects sleep here, and only get woken while someone is waiting
+    NSCondition *_condition;
+    atomic_ulong _waiters;
+    
+}
+
+#pragma mark - Public Class Methods
+
++ (instancetype)queue {
+    
+    return [[self alloc] init];
+    
+}
+
++ (instancetype)queueWithCapacity:(NSUInteger)capacity {
+    
+    return [[self alloc] initWithCapacity:capacity];
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (instancetype)init {
+    
+    self = [self initWithCapacity:1024];
+    
+    return self;
+    
+}
+
+- (void)dealloc {
+    
+    // Consumers keep their queue alive, so there are none left to read the ring
+    for (NSUInteger i = 0; i <= _ring.mask; i++) {
+        
+        if (_ring.slots[i])
+            CFRelease(_ring.slots[i]);
+        
+    }
+    
+    free(_ring.slots);
+    free(_cursors);
+    
+}
+
+- (NSString *)description {
+    
+    return [NSString stringWithFormat:@"<%@: %p; count = %lu; consumers = %lu>", NSStringFromClass([self class]), self, (unsigned long)self.count, (unsigned long)self.consumerCount];
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (NSUInteger)capacity {
+    
+    return _capacity;
+    
+}
+
+- (NSUInteger)consumerCount {
+    
+    os_unfair_lock_lock(&_producerLock);
+    NSUInteger count = _cursorCount;
+    os_unfair_lock_unlock(&_producerLock);
+    
+    return count;
+    
+}
+
+- (NSUInteger)count {
+    
+    os_unfair_lock_lock(&_producerLock);
+    uint64_t published = atomic_load_explicit(&_ring.published, memory_order_relaxed);
+    NSUInteger count = (NSUInteger)(published - [self slowestCursor]);
+    os_unfair_lock_unlock(&_producerLock);
+    
+    return count;
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    
+    if (capacity == 0) {
+        
+        [NSException raise:NSInvalidArgumentException format:@"A broadcast queue needs room for at least one object"];
+        
+    }
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _capacity = 1;
+        
+        while (_capacity < capacity) {
+            
+            _capacity <<= 1;
+            
+        }
+        
+        _ring.slots = calloc(_capacity, sizeof(void *));
+        _ring.mask = _capacity - 1;
+        atomic_init(&_ring.published, 0);
+        _producerLock = OS_UNFAIR_LOCK_INIT;
+        _condition = [[NSCondition alloc] init];
+        atomic_init(&_waiters, 0);
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Consumers
+
+- (BroadcastConsumer *)addConsumer {
+    
+    BroadcastConsumer *consumer = [[BroadcastConsumer alloc] initWithQueue:self ring:&_ring];
+    
+    os_unfair_lock_lock(&_producerLock);
+    
+    if (_cursorCount == _cursorCapacity) {
+        
+        _cursorCapacity = MAX(4, 2 * _cursorCapacity);
+        _cursors = realloc(_cursors, _cursorCapacity * sizeof(_Atomic(uint64_t) *));
+        
+    }
+    
+    // Start at the next object to be published, which can't be overwritten until this cursor moves past it
+    atomic_store(&consumer->_cursor, atomic_load_explicit(&_ring.published, memory_order_relaxed));
+    _cursors[_cursorCount++] = &consumer->_cursor;
+    
+    os_unfair_lock_unlock(&_producerLock);
+    
+    return consumer;
+    
+}
+
+- (void)removeConsumer:(BroadcastConsumer *)consumer {
+    
+    atomic_store(&consumer->_removed, YES);
+    [self unregisterCursor:&consumer->_cursor];
+    
+}
+
+#pragma mark - Enqueueing
+
+- (void)enqueue:(id)object {
+    
+    while (![self tryEnqueue:object]) {
+        
+        [self waitUntilDate:[NSDate distantFuture] forCondition:^BOOL{
+            
+            return [self availableRoom] > 0;
+            
+        }];
+        
+    }
+    
+}
+
+- (BOOL)tryEnqueue:(id)object {
+    
+    os_unfair_lock_lock(&_producerLock);
+    
+    if ([self reserveRoom] == 0) {
+        
+        os_unfair_lock_unlock(&_producerLock);
+        
+        return NO;
+        
+    }
+    
+    uint64_t sequence = atomic_load_explicit(&_ring.published, memory_order_relaxed);
+    const void **slot = &_ring.slots[sequence & _ring.mask];
+    const void *overwritten = *slot;
+    
+    *slot = CFBridgingRetain(object);
+    atomic_store(&_ring.published, sequence + 1);
+    
+    os_unfair_lock_unlock(&_producerLock);
+    
+    if (overwritten)
+        CFRelease(overwritten);
+    
+    [self wakeWaiters];
+    
+    return YES;
+    
+}
+
+- (void)enqueueObjects:(NSArray *)objects {
+    
+    NSUInteger count = objects.count;
+    NSUInteger location = 0;
+    const void *overwritten[SQBroadcastQueueReleaseBatch];
+    
+    while (location < count) {
+        
+        os_unfair_lock_lock(&_producerLock);
+        
+        NSUInteger length = MIN(MIN([self reserveRoom], count - location), SQBroadcastQueueReleaseBatch);
+        uint64_t sequence = atomic_load_explicit(&_ring.published, memory_order_relaxed);
+        
+        for (NSUInteger i = 0; i < length; i++) {
+            
+            const void **slot = &_ring.slots[(sequence + i) & _ring.mask];
+            overwritten[i] = *slot;
+            *slot = CFBridgingRetain(objects[location + i]);
+            
+        }
+        
+        atomic_store(&_ring.published, sequence + length);
+        
+        os_unfair_lock_unlock(&_producerLock);
+        
+        for (NSUInteger i = 0; i < length; i++) {
+            
+            if (overwritten[i])
+                CFRelease(overwritten[i]);
+            
+        }
+        
+        if (length > 0) {
+            
+            location += length;
+            [self wakeWaiters];
+            
+        } else {
+            
+            [self waitUntilDate:[NSDate distantFuture] forCondition:^BOOL{
+                
+                return [self availableRoom] > 0;
+                
+            }];
+            
+        }
+        
+    }
+    
+}
+
+#pragma mark - Private Instance Methods
+
+/**
+ The slowest cursor, or the next sequence to publish if there are no consumers. Call with the producer lock held.
+ 
+ @return The sequence
+ */
+- (uint64_t)slowestCursor {
+    
+    uint64_t slowest = atomic_load_explicit(&_ring.published, memory_order_relaxed);
+    
+    for (NSUInteger i = 0; i < _cursorCount; i++) {
+        
+        slowest = MIN(slowest, atomic_load(_cursors[i]));
+        
+    }
+    
+    return slowest;
+    
+}
+
+/**
+ The number of objects that can be published without overwriting one a consumer hasn't read, only looking at the cursors when the last look doesn't leave any room. Call with the producer lock held.
+ 
+ @return The number of objects
+ */
+- (NSUInteger)reserveRoom {
+    
+    uint64_t published = atomic_load_explicit(&_ring.published, memory_order_relaxed);
+    
+    if (published - _gate >= _capacity) {
+        
+        _gate = [self slowestCursor];
+        
+    }
+    
+    return _capacity - (NSUInteger)(published - _gate);
+    
+}
+
+- (NSUInteger)availableRoom {
+    
+    os_unfair_lock_lock(&_producerLock);
+    NSUInteger room = [self reserveRoom];
+    os_unfair_lock_unlock(&_producerLock);
+    
+    return room;
+    
+}
+
+- (void)unregisterCursor:(_Atomic(uint64_t) *)cursor {
+    
+    os_unfair_lock_lock(&_producerLock);
+    
+    for (NSUInteger i = 0; i < _cursorCount; i++) {
+        
+        if (_cursors[i] == cursor) {
+            
+            _cursors[i] = _cursors[--_cursorCount];
+            break;
+            
+        }
+        
+    }
+    
+    os_unfair_lock_unlock(&_producerLock);
+    
+    // The slowest consumer may just have gone
+    [self wakeWaiters];
+    
+}
+
+- (void)wakeWaiters {
+    
+    // Pairs with the increment in -waitUntilDate:forCondition:, so either we see the waiter or it sees our change
+    if (atomic_load(&_waiters) == 0)
+        return;
+    
+    [_condition lock];
+    [_condition broadcast];
+    [_condition unlock];
+    
+}
+
+- (BOOL)waitUntilDate:(NSDate *)limit forCondition:(BOOL (^)(void))condition {
+    
+    [_condition lock];
+    atomic_fetch_add(&_waiters, 1);
+    
+    BOOL satisfied = condition();
+    
+    while (!satisfied && [_condition waitUntilDate:limit]) {
+        
+        satisfied = condition();
+        
+    }
+    
+    if (!satisfied)
+        satisfied = condition();
+    
+    atomic_fetch_sub(&_waiters, 1);
+    [_condition unlock];
+    
+    return satisfied;
+    
+}
+
+@end
+
+@implementation BroadcastConsumer {
+    
+    BroadcastQueue *_queue;
+    SQBroadcastRing *_ring;
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (void)dealloc {
+    
+    [_queue unregisterCursor:&_cursor];
+    
+}
+
+- (NSString *)description {
+    
+    return [NSString stringWithFormat:@"<%@: %p; count = %lu>", NSStringFromClass([self class]), self, (unsigned long)self.count];
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (BroadcastQueue *)queue {
+    
+    return _queue;
+    
+}
+
+- (NSUInteger)count {
+    
+    if (atomic_load_explicit(&_removed, memory_order_relaxed))
+        return 0;
+    
+    // Sequentially consistent, to pair with the producer's check for waiters
+    return (NSUInteger)(atomic_load(&_ring->published) - atomic_load_explicit(&_cursor, memory_order_relaxed));
+    
+}
+
+#pragma mark - Dequeueing
+
+- (id)dequeue {
+    
+    uint64_t cursor = atomic_load_explicit(&_cursor, memory_order_relaxed);
+    
+    if (atomic_load_explicit(&_removed, memory_order_relaxed) || cursor == atomic_load_explicit(&_ring->published, memory_order_acquire))
+        return nil;
+    
+    // Take our own reference before moving past the slot, since the producer may reuse it straight after
+    id object = (__bridge id)_ring->slots[cursor & _ring->mask];
+    [self advanceTo:cursor + 1];
+    
+    return object;
+    
+}
+
+- (NSArray *)dequeueUpTo:(NSUInteger)maximumCount {
+    
+    NSUInteger length = MIN(self.count, maximumCount);
+    
+    if (length == 0)
+        return @[];
+    
+    uint64_t cursor = atomic_load_explicit(&_cursor, memory_order_relaxed);
+    NSUInteger offset = (NSUInteger)(cursor & _ring->mask);
+    NSUInteger firstLength = MIN(length, _ring->mask + 1 - offset);
+    NSArray *objects;
+    
+    if (firstLength == length) {
+        
+        objects = [NSArray arrayWithObjects:(__unsafe_unretained id *)(void *)&_ring->slots[offset] count:length];
+        
+    } else {
+        
+        // The run wraps around the end of the ring, so gather its two pieces first
+        const void **gathered = malloc(length * sizeof(void *));
+        memcpy(gathered, &_ring->slots[offset], firstLength * sizeof(void *));
+        memcpy(gathered + firstLength, _ring->slots, (length - firstLength) * sizeof(void *));
+        objects = [NSArray arrayWithObjects:(__unsafe_unretained id *)(void *)gathered count:length];
+        free(gathered);
+        
+    }
+    
+    [self advanceTo:cursor + length];
+    
+    return objects;
+    
+}
+
+- (NSArray *)dequeueUpTo:(NSUInteger)maximumCount waitingUntilDate:(NSDate *)limit {
+    
+    if (maximumCount == 0)
+        return @[];
+    
+    [_queue waitUntilDate:limit forCondition:^BOOL{
+        
+        return self.count > 0;
+        
+    }];
+    
+    return [self dequeueUpTo:maximumCount];
+    
+}
+
+- (NSUInteger)dequeueAvailableObjectsUsingBlock:(void (NS_NOESCAPE ^)(id _Nonnull, BOOL * _Nonnull))block {
+    
+    uint64_t cursor = atomic_load_explicit(&_cursor, memory_order_relaxed);
+    uint64_t published = atomic_load_explicit(&_removed, memory_order_relaxed) ? cursor : atomic_load_explicit(&_ring->published, memory_order_acquire);
+    uint64_t sequence = cursor;
+    BOOL stop = NO;
+    
+    // Every slot we haven't moved past is safe from the producer, so objects are handed out without being retained
+    while (sequence < published && !stop) {
+        
+        block((__bridge id)_ring->slots[sequence & _ring->mask], &stop);
+        sequence++;
+        
+    }
+    
+    if (sequence > cursor)
+        [self advanceTo:sequence];
+    
+    return (NSUInteger)(sequence - cursor);
+    
+}
+
+#pragma mark - Private Instance Methods
+
+- (instancetype)initWithQueue:(BroadcastQueue *)queue ring:(SQBroadcastRing *)ring {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _queue = queue;
+        _ring = ring;
+        atomic_init(&_cursor, 0);
+        atomic_init(&_removed, NO);
+        
+    }
+    
+    return self;
+    
+}
+
+/**
+ Move the cursor forward, releasing the slots behind it to the producer
+ 
+ @param sequence The new cursor
+ */
+- (void)advanceTo:(uint64_t)sequence {
+    
+    atomic_store(&_cursor, sequence);
+    [_queue wakeWaiters];
+    
+}
+
+@end
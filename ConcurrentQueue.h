@@ -0,0 +1,98 @@
+//
+//  ConcurrentQueue.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+#import "Queueing.h"
+
+/**
+ An unbounded, thread-safe FIFO Queue in Objective-C
+ 
+ @discussion Producers and consumers synchronize on separate locks (the two-lock queue of Michael & Scott), so enqueueing and dequeueing proceed in parallel and only contend with their own side. Objects are stored in a linked list of fixed-size chunks rather than one node per object, and drained chunks are recycled through a small freelist.
+ */
+@interface ConcurrentQueue<__covariant ObjectType> : NSObject<Queueing>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @name Factory Methods
+ */
+
+/**
+ Create an empty queue
+ 
+ @return The queue
+ */
++ (instancetype)queue;
+
+/**
+ Create a queue with an NSArray
+ 
+ @param array The NSArray
+ @return The queue
+ */
++ (instancetype)queueWithArray:(NSArray<ObjectType> *)array;
+
+/**
+ @name Initializers
+ */
+
+/**
+ Create a queue with an NSArray
+ 
+ @param array The NSArray
+ @return The queue
+ */
+- (instancetype)initWithArray:(NSArray<ObjectType> *)array NS_DESIGNATED_INITIALIZER;
+
+/**
+ @name Enqueue, Peek, Dequeue
+ */
+
+/**
+ Enqueue an object. Safe to call from any thread.
+ 
+ @param object The object
+ */
+- (void)enqueue:(ObjectType)object;
+
+/**
+ Enqueue an array of objects, in order, without interleaving objects from other producers. Safe to call from any thread.
+ 
+ @param objects The array
+ */
+- (void)enqueueObjects:(NSArray<ObjectType> *)objects;
+
+/**
+ View the item in the front of the queue. Safe to call from any thread, but another consumer may dequeue the item at any time.
+ 
+ @return The item at the front of the queue
+ */
+- (nullable ObjectType)peek;
+
+/**
+ Dequeue an item from the front of the queue. Safe to call from any thread.
+ 
+ @return The item, or nil if the queue is empty
+ */
+- (nullable ObjectType)dequeue;
+
+/**
+ @name Content Checking
+ */
+
+/**
+ The number of items in the queue
+ 
+ @note With producers and consumers running, this is only a snapshot
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+NS_ASSUME_NONNULL_END
+
+@end
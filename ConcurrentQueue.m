@@ -0,0 +1,316 @@
+//
+//  ConcurrentQueue.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ConcurrentQueue.h"
+
+#import <os/lock.h>
+#import <stdatomic.h>
+
+#define SQConcurrentQueueNodeCapacity 256
+#define SQConcurrentQueueMaxFreeNodes 16
+#define SQCacheLineSize 128
+
+/**
+ A chunk of the queue's linked list. Only the producer holding the tail lock writes to a node; it publishes each slot with a release store, so a consumer can read up to `published` without taking the tail lock.
+ */
+typedef struct SQConcurrentQueueNode {
+    
+    _Atomic(struct SQConcurrentQueueNode *) next;
+    _Atomic(NSUInteger) published;
+    const void *objects[SQConcurrentQueueNodeCapacity];
+    
+} SQConcurrentQueueNode;
+
+@implementation ConcurrentQueue {
+    
+    // Consumer side. The dequeued total is only written with the head lock held.
+    os_unfair_lock _headLock;
+    SQConcurrentQueueNode *_headNode;
+    NSUInteger _headIndex;
+    _Atomic(NSUInteger) _dequeuedCount;
+    char _headPadding[SQCacheLineSize];
+    
+    // Producer side. The enqueued total is only written with the tail lock held.
+    os_unfair_lock _tailLock;
+    SQConcurrentQueueNode *_tailNode;
+    _Atomic(NSUInteger) _enqueuedCount;
+    char _tailPadding[SQCacheLineSize];
+    
+    // Shared by both sides, but only touched once per node
+    os_unfair_lock _freeLock;
+    SQConcurrentQueueNode *_freeNodes;
+    NSUInteger _freeCount;
+    char _freePadding[SQCacheLineSize];
+    
+}
+
+#pragma mark - Public Class Methods
+
++ (instancetype)queue {
+    
+    return [[self alloc] init];
+    
+}
+
++ (instancetype)queueWithArray:(NSArray *)array {
+    
+    return [[self alloc] initWithArray:array];
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (instancetype)init {
+    
+    self = [self initWithArray:@[]];
+    
+    return self;
+    
+}
+
+- (void)dealloc {
+    
+    SQConcurrentQueueNode *node = _headNode;
+    NSUInteger index = _headIndex;
+    
+    while (node) {
+        
+        NSUInteger published = atomic_load_explicit(&node->published, memory_order_relaxed);
+        
+        for (; index < published; index++) {
+            
+            CFRelease(node->objects[index]);
+            
+        }
+        
+        SQConcurrentQueueNode *next = atomic_load_explicit(&node->next, memory_order_relaxed);
+        free(node);
+        node = next;
+        index = 0;
+        
+    }
+    
+    while (_freeNodes) {
+        
+        SQConcurrentQueueNode *next = atomic_load_explicit(&_freeNodes->next, memory_order_relaxed);
+        free(_freeNodes);
+        _freeNodes = next;
+        
+    }
+    
+}
+
+- (NSString *)description {
+    
+    return [NSString stringWithFormat:@"<%@: %p; count = %lu>", NSStringFromClass([self class]), self, (unsigned long)self.count];
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (NSUInteger)count {
+    
+    // Each side keeps its own total, so neither touches the other's cache line. A consumer can dequeue an object before its producer has counted it, so the difference can briefly dip below zero.
+    NSUInteger dequeued = atomic_load_explicit(&_dequeuedCount, memory_order_acquire);
+    NSUInteger enqueued = atomic_load_explicit(&_enqueuedCount, memory_order_acquire);
+    
+    return enqueued - MIN(dequeued, enqueued);
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithArray:(NSArray *)array {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _headLock = OS_UNFAIR_LOCK_INIT;
+        _tailLock = OS_UNFAIR_LOCK_INIT;
+        _freeLock = OS_UNFAIR_LOCK_INIT;
+        _headNode = _tailNode = [self createNode];
+        atomic_init(&_enqueuedCount, 0);
+        atomic_init(&_dequeuedCount, 0);
+        
+        [self enqueueObjects:array];
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Enqueue Peek Dequeue
+
+- (void)enqueue:(id)object {
+    
+    os_unfair_lock_lock(&_tailLock);
+    [self appendObject:object];
+    atomic_store_explicit(&_enqueuedCount, atomic_load_explicit(&_enqueuedCount, memory_order_relaxed) + 1, memory_order_release);
+    os_unfair_lock_unlock(&_tailLock);
+    
+}
+
+- (void)enqueueObjects:(NSArray *)objects {
+    
+    if (objects.count == 0)
+        return;
+    
+    os_unfair_lock_lock(&_tailLock);
+    
+    for (id object in objects) {
+        
+        [self appendObject:object];
+        
+    }
+    
+    atomic_store_explicit(&_enqueuedCount, atomic_load_explicit(&_enqueuedCount, memory_order_relaxed) + objects.count, memory_order_release);
+    os_unfair_lock_unlock(&_tailLock);
+    
+}
+
+- (id)peek {
+    
+    os_unfair_lock_lock(&_headLock);
+    
+    id object = nil;
+    
+    if ([self advanceHead]) {
+        
+        object = (__bridge id)_headNode->objects[_headIndex];
+        
+    }
+    
+    os_unfair_lock_unlock(&_headLock);
+    
+    return object;
+    
+}
+
+- (id)dequeue {
+    
+    os_unfair_lock_lock(&_headLock);
+    
+    id object = nil;
+    
+    if ([self advanceHead]) {
+        
+        object = CFBridgingRelease(_headNode->objects[_headIndex]);
+        _headNode->objects[_headIndex] = NULL;
+        _headIndex++;
+        atomic_store_explicit(&_dequeuedCount, atomic_load_explicit(&_dequeuedCount, memory_order_relaxed) + 1, memory_order_release);
+        
+    }
+    
+    os_unfair_lock_unlock(&_headLock);
+    
+    return object;
+    
+}
+
+#pragma mark - Private Instance Methods
+
+/**
+ Append an object at the tail. Must be called with the tail lock held.
+ 
+ @param object The object
+ */
+- (void)appendObject:(id)object {
+    
+    SQConcurrentQueueNode *node = _tailNode;
+    NSUInteger index = atomic_load_explicit(&node->published, memory_order_relaxed);
+    
+    if (index == SQConcurrentQueueNodeCapacity) {
+        
+        // Once `next` is set the consumer may recycle the full node, so never touch it again
+        SQConcurrentQueueNode *next = [self createNode];
+        atomic_store_explicit(&node->next, next, memory_order_release);
+        _tailNode = node = next;
+        index = 0;
+        
+    }
+    
+    node->objects[index] = CFBridgingRetain(object);
+    atomic_store_explicit(&node->published, index + 1, memory_order_release);
+    
+}
+
+/**
+ Move the head past a drained node if there is another one, and check for an object to dequeue. Must be called with the head lock held.
+ 
+ @return YES if there is an object at the head
+ */
+- (BOOL)advanceHead {
+    
+    if (_headIndex == SQConcurrentQueueNodeCapacity) {
+        
+        SQConcurrentQueueNode *next = atomic_load_explicit(&_headNode->next, memory_order_acquire);
+        
+        if (!next)
+            return NO;
+        
+        [self recycleNode:_headNode];
+        _headNode = next;
+        _headIndex = 0;
+        
+    }
+    
+    return _headIndex < atomic_load_explicit(&_headNode->published, memory_order_acquire);
+    
+}
+
+- (SQConcurrentQueueNode *)createNode {
+    
+    SQConcurrentQueueNode *node = NULL;
+    
+    os_unfair_lock_lock(&_freeLock);
+    
+    if (_freeNodes) {
+        
+        node = _freeNodes;
+        _freeNodes = atomic_load_explicit(&node->next, memory_order_relaxed);
+        _freeCount--;
+        
+    }
+    
+    os_unfair_lock_unlock(&_freeLock);
+    
+    if (!node) {
+        
+        node = malloc(sizeof(SQConcurrentQueueNode));
+        
+    }
+    
+    atomic_init(&node->next, NULL);
+    atomic_init(&node->published, 0);
+    
+    return node;
+    
+}
+
+- (void)recycleNode:(SQConcurrentQueueNode *)node {
+    
+    os_unfair_lock_lock(&_freeLock);
+    
+    if (_freeCount < SQConcurrentQueueMaxFreeNodes) {
+        
+        atomic_store_explicit(&node->next, _freeNodes, memory_order_relaxed);
+        _freeNodes = node;
+        _freeCount++;
+        node = NULL;
+        
+    }
+    
+    os_unfair_lock_unlock(&_freeLock);
+    
+    free(node);
+    
+}
+
+@end
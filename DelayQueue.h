@@ -0,0 +1,114 @@
+//
+//  DelayQueue.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+/**
+ A thread-safe Queue in Objective-C whose objects only become available once their deadline has passed
+ 
+ @discussion Deadlines are kept in a hierarchical timing wheel (four levels of 64 slots), so scheduling and cancelling are O(1), and each tick expires its objects in bulk instead of scanning the whole queue. Deadlines are rounded up to the queue's tick interval. Objects that become ready on the same tick are dequeued in the order they were scheduled.
+ */
+@interface DelayQueue<__covariant ObjectType> : NSObject
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @name Factory Methods
+ */
+
+/**
+ Create an empty delay queue with a 10 millisecond tick
+ 
+ @return The delay queue
+ */
++ (instancetype)queue;
+
+/**
+ @name Initializers
+ */
+
+/**
+ Create an empty delay queue
+ 
+ @param tickInterval The resolution of the timing wheel. Must be positive.
+ @return The delay queue
+ */
+- (instancetype)initWithTickInterval:(NSTimeInterval)tickInterval NS_DESIGNATED_INITIALIZER;
+
+/**
+ @name Scheduling
+ */
+
+/**
+ Enqueue an object that becomes ready after a delay. Enqueueing an object that is already scheduled reschedules it.
+ 
+ @param object The object
+ @param delay The delay
+ */
+- (void)enqueue:(ObjectType)object afterDelay:(NSTimeInterval)delay;
+
+/**
+ Enqueue an object that becomes ready at a date. Enqueueing an object that is already scheduled reschedules it.
+ 
+ @param object The object
+ @param date The date
+ */
+- (void)enqueue:(ObjectType)object atDate:(NSDate *)date;
+
+/**
+ Cancel a scheduled object, whether or not it is ready yet
+ 
+ @note Objects are matched by identity, not equality
+ @param object The object
+ @return YES if the object was scheduled, otherwise NO.
+ */
+- (BOOL)cancel:(ObjectType)object;
+
+/**
+ @name Dequeueing
+ */
+
+/**
+ Dequeue every object whose deadline has passed, without blocking
+ 
+ @return The ready objects, in deadline order, which may be empty
+ */
+- (NSArray<ObjectType> *)dequeueReadyObjects;
+
+/**
+ Dequeue every object whose deadline has passed, sleeping until the next deadline if none are ready yet
+ 
+ @param limit The latest date to wait until
+ @return The ready objects, in deadline order, or an empty array if none became ready before the limit
+ */
+- (NSArray<ObjectType> *)dequeueReadyObjectsWaitingUntilDate:(NSDate *)limit;
+
+/**
+ @name Content Checking
+ */
+
+/**
+ The number of scheduled objects, ready or not
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+/**
+ The resolution of the timing wheel
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSTimeInterval tickInterval;
+
+/**
+ The date the next object becomes ready, or nil if nothing is scheduled
+ 
+ @note For objects more than 64 ticks out this is the next date the timing wheel needs attention, which may be earlier than the deadline itself
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly, nullable) NSDate *nextDeadline;
+
+NS_ASSUME_NONNULL_END
+
+@end
@@ -0,0 +1,514 @@
+//
+//  DelayQueue.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "DelayQueue.h"
+
+#import <time.h>
+
+#define SQDelayQueueLevelBits 6
+#define SQDelayQueueSlotCount (1 << SQDelayQueueLevelBits)
+#define SQDelayQueueSlotMask (SQDelayQueueSlotCount - 1)
+#define SQDelayQueueLevelCount 4
+#define SQDelayQueueWheelSpan ((uint64_t)1 << (SQDelayQueueLevelBits * SQDelayQueueLevelCount))
+
+struct SQDelayQueueList;
+
+/**
+ A scheduled object, linked into exactly one list
+ */
+typedef struct SQDelayQueueEntry {
+    
+    struct SQDelayQueueEntry *prev;
+    struct SQDelayQueueEntry *next;
+    struct SQDelayQueueList *list;
+    uint64_t deadline;
+    const void *object;
+    
+} SQDelayQueueEntry;
+
+typedef struct SQDelayQueueList {
+    
+    SQDelayQueueEntry *head;
+    SQDelayQueueEntry *tail;
+    
+} SQDelayQueueList;
+
+NS_INLINE void SQDelayQueueListAppend(SQDelayQueueList *list, SQDelayQueueEntry *entry) {
+    
+    entry->list = list;
+    entry->next = NULL;
+    entry->prev = list->tail;
+    
+    if (list->tail)
+        list->tail->next = entry;
+    else
+        list->head = entry;
+    
+    list->tail = entry;
+    
+}
+
+NS_INLINE void SQDelayQueueListRemove(SQDelayQueueEntry *entry) {
+    
+    SQDelayQueueList *list = entry->list;
+    
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        list->head = entry->next;
+    
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        list->tail = entry->prev;
+    
+    entry->list = NULL;
+    
+}
+
+/**
+ Take every entry out of a list, leaving it empty
+ 
+ @param list The list
+ @return The first entry, still linked to the rest
+ */
+NS_INLINE SQDelayQueueEntry *SQDelayQueueListDetach(SQDelayQueueList *list) {
+    
+    SQDelayQueueEntry *head = list->head;
+    list->head = list->tail = NULL;
+    
+    return head;
+    
+}
+
+@implementation DelayQueue {
+    
+    NSCondition *_condition;
+    uint64_t _origin;
+    uint64_t _tickNanoseconds;
+    uint64_t _currentTick;
+    
+    SQDelayQueueList _wheel[SQDelayQueueLevelCount][SQDelayQueueSlotCount];
+    SQDelayQueueList _overflow;
+    SQDelayQueueList _ready;
+    NSUInteger _scheduledCount;
+    
+    // Object identity -> entry, for O(1) cancellation
+    CFMutableDictionaryRef _entries;
+    
+}
+
+#pragma mark - Public Class Methods
+
++ (instancetype)queue {
+    
+    return [[self alloc] init];
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (instancetype)init {
+    
+    self = [self initWithTickInterval:0.01];
+    
+    return self;
+    
+}
+
+- (void)dealloc {
+    
+    SQDelayQueueList *lists[] = { &_ready, &_overflow };
+    
+    for (NSUInteger i = 0; i < 2; i++) {
+        
+        [self freeEntries:SQDelayQueueListDetach(lists[i])];
+        
+    }
+    
+    for (NSUInteger level = 0; level < SQDelayQueueLevelCount; level++) {
+        
+        for (NSUInteger slot = 0; slot < SQDelayQueueSlotCount; slot++) {
+            
+            [self freeEntries:SQDelayQueueListDetach(&_wheel[level][slot])];
+            
+        }
+        
+    }
+    
+    CFRelease(_entries);
+    
+}
+
+- (NSString *)description {
+    
+    return [NSString stringWithFormat:@"<%@: %p; count = %lu>", NSStringFromClass([self class]), self, (unsigned long)self.count];
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (NSUInteger)count {
+    
+    [_condition lock];
+    NSUInteger count = (NSUInteger)CFDictionaryGetCount(_entries);
+    [_condition unlock];
+    
+    return count;
+    
+}
+
+- (NSTimeInterval)tickInterval {
+    
+    return (NSTimeInterval)_tickNanoseconds / NSEC_PER_SEC;
+    
+}
+
+- (NSDate *)nextDeadline {
+    
+    [_condition lock];
+    [self advanceToTick:[self now]];
+    NSDate *date = [self nextEventDate];
+    [_condition unlock];
+    
+    return date;
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithTickInterval:(NSTimeInterval)tickInterval {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _condition = [[NSCondition alloc] init];
+        _origin = clock_gettime_nsec_np(CLOCK_MONOTONIC);
+        _tickNanoseconds = MAX(1, (uint64_t)(tickInterval * NSEC_PER_SEC));
+        _entries = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Scheduling
+
+- (void)enqueue:(id)object afterDelay:(NSTimeInterval)delay {
+    
+    [_condition lock];
+    
+    uint64_t elapsed = [self elapsedNanoseconds];
+    uint64_t now = elapsed / _tickNanoseconds;
+    
+    // Round the deadline itself up, not just the delay, so the entry can't be released before the delay has fully passed
+    uint64_t delayNanoseconds = delay > 0 ? (uint64_t)ceil(delay * NSEC_PER_SEC) : 0;
+    uint64_t deadline = delayNanoseconds > 0 ? (elapsed + delayNanoseconds + _tickNanoseconds - 1) / _tickNanoseconds : now;
+    
+    // Pull the wheel up to date first, so the new entry is placed relative to the present
+    [self advanceToTick:now];
+    
+    SQDelayQueueEntry *entry = (SQDelayQueueEntry *)CFDictionaryGetValue(_entries, (__bridge const void *)object);
+    
+    if (entry) {
+        
+        [self unlinkEntry:entry];
+        
+    } else {
+        
+        entry = malloc(sizeof(SQDelayQueueEntry));
+        entry->object = CFBridgingRetain(object);
+        CFDictionarySetValue(_entries, entry->object, entry);
+        
+    }
+    
+    entry->deadline = deadline;
+    [self insertEntry:entry];
+    
+    [_condition broadcast];
+    [_condition unlock];
+    
+}
+
+- (void)enqueue:(id)object atDate:(NSDate *)date {
+    
+    [self enqueue:object afterDelay:date.timeIntervalSinceNow];
+    
+}
+
+- (BOOL)cancel:(id)object {
+    
+    [_condition lock];
+    
+    SQDelayQueueEntry *entry = (SQDelayQueueEntry *)CFDictionaryGetValue(_entries, (__bridge const void *)object);
+    
+    if (entry) {
+        
+        [self unlinkEntry:entry];
+        CFDictionaryRemoveValue(_entries, entry->object);
+        CFRelease(entry->object);
+        free(entry);
+        
+    }
+    
+    [_condition unlock];
+    
+    return entry != NULL;
+    
+}
+
+#pragma mark - Dequeueing
+
+- (NSArray *)dequeueReadyObjects {
+    
+    [_condition lock];
+    
+    [self advanceToTick:[self now]];
+    NSArray *objects = [self drainReadyObjects];
+    
+    [_condition unlock];
+    
+    return objects;
+    
+}
+
+- (NSArray *)dequeueReadyObjectsWaitingUntilDate:(NSDate *)limit {
+    
+    [_condition lock];
+    
+    NSArray *objects;
+    
+    while (YES) {
+        
+        [self advanceToTick:[self now]];
+        objects = [self drainReadyObjects];
+        
+        if (objects.count > 0 || limit.timeIntervalSinceNow <= 0)
+            break;
+        
+        // Sleep until the wheel next needs attention; enqueueing something sooner wakes us early
+        NSDate *next = [self nextEventDate];
+        [_condition waitUntilDate:next ? [next earlierDate:limit] : limit];
+        
+    }
+    
+    [_condition unlock];
+    
+    return objects;
+    
+}
+
+#pragma mark - Private Instance Methods
+
+- (uint64_t)elapsedNanoseconds {
+    
+    return clock_gettime_nsec_np(CLOCK_MONOTONIC) - _origin;
+    
+}
+
+- (uint64_t)now {
+    
+    return [self elapsedNanoseconds] / _tickNanoseconds;
+    
+}
+
+/**
+ Place an entry in the list for its deadline, relative to the current tick
+ 
+ @discussion An entry goes in the lowest level where its deadline and the current tick agree on every higher bit, so it only needs to move down a level when the wheel rolls over into its slot.
+ @param entry The entry
+ */
+- (void)insertEntry:(SQDelayQueueEntry *)entry {
+    
+    if (entry->deadline <= _currentTick) {
+        
+        SQDelayQueueListAppend(&_ready, entry);
+        return;
+        
+    }
+    
+    _scheduledCount++;
+    
+    uint64_t difference = entry->deadline ^ _currentTick;
+    
+    for (NSUInteger level = 0; level < SQDelayQueueLevelCount; level++) {
+        
+        if (difference < ((uint64_t)1 << (SQDelayQueueLevelBits * (level + 1)))) {
+            
+            NSUInteger slot = (entry->deadline >> (SQDelayQueueLevelBits * level)) & SQDelayQueueSlotMask;
+            SQDelayQueueListAppend(&_wheel[level][slot], entry);
+            
+            return;
+            
+        }
+        
+    }
+    
+    SQDelayQueueListAppend(&_overflow, entry);
+    
+}
+
+- (void)unlinkEntry:(SQDelayQueueEntry *)entry {
+    
+    if (entry->list != &_ready) {
+        
+        _scheduledCount--;
+        
+    }
+    
+    SQDelayQueueListRemove(entry);
+    
+}
+
+- (void)cascadeList:(SQDelayQueueList *)list {
+    
+    SQDelayQueueEntry *entry = SQDelayQueueListDetach(list);
+    
+    while (entry) {
+        
+        SQDelayQueueEntry *next = entry->next;
+        _scheduledCount--;
+        [self insertEntry:entry];
+        entry = next;
+        
+    }
+    
+}
+
+- (void)advanceToTick:(uint64_t)tick {
+    
+    while (_currentTick < tick) {
+        
+        if (_scheduledCount == 0) {
+            
+            // Nothing left on the wheel, so there's nothing to expire along the way
+            _currentTick = tick;
+            break;
+            
+        }
+        
+        uint64_t current = ++_currentTick;
+        
+        if ((current & (SQDelayQueueWheelSpan - 1)) == 0) {
+            
+            [self cascadeList:&_overflow];
+            
+        }
+        
+        // Roll higher levels down first, so entries can fall through more than one level in a single tick
+        for (NSUInteger level = SQDelayQueueLevelCount - 1; level > 0; level--) {
+            
+            if ((current & (((uint64_t)1 << (SQDelayQueueLevelBits * level)) - 1)) == 0) {
+                
+                [self cascadeList:&_wheel[level][(current >> (SQDelayQueueLevelBits * level)) & SQDelayQueueSlotMask]];
+                
+            }
+            
+        }
+        
+        // Everything in this slot expires now
+        SQDelayQueueList *expired = &_wheel[0][current & SQDelayQueueSlotMask];
+        SQDelayQueueEntry *entry = SQDelayQueueListDetach(expired);
+        
+        while (entry) {
+            
+            SQDelayQueueEntry *next = entry->next;
+            _scheduledCount--;
+            SQDelayQueueListAppend(&_ready, entry);
+            entry = next;
+            
+        }
+        
+    }
+    
+}
+
+- (NSArray *)drainReadyObjects {
+    
+    NSMutableArray *objects = [NSMutableArray array];
+    SQDelayQueueEntry *entry = SQDelayQueueListDetach(&_ready);
+    
+    while (entry) {
+        
+        SQDelayQueueEntry *next = entry->next;
+        CFDictionaryRemoveValue(_entries, entry->object);
+        [objects addObject:CFBridgingRelease(entry->object)];
+        free(entry);
+        entry = next;
+        
+    }
+    
+    return objects;
+    
+}
+
+- (NSDate *)nextEventDate {
+    
+    if (_ready.head) {
+        
+        return [NSDate date];
+        
+    }
+    
+    if (_scheduledCount == 0) {
+        
+        return nil;
+        
+    }
+    
+    uint64_t tick = 0;
+    
+    for (NSUInteger level = 0; level < SQDelayQueueLevelCount && tick == 0; level++) {
+        
+        NSUInteger shift = SQDelayQueueLevelBits * level;
+        NSUInteger currentSlot = (_currentTick >> shift) & SQDelayQueueSlotMask;
+        
+        for (NSUInteger slot = currentSlot + 1; slot < SQDelayQueueSlotCount; slot++) {
+            
+            if (_wheel[level][slot].head) {
+                
+                // The start of the block this slot covers
+                uint64_t blockMask = ((uint64_t)1 << (shift + SQDelayQueueLevelBits)) - 1;
+                tick = (_currentTick & ~blockMask) | ((uint64_t)slot << shift);
+                break;
+                
+            }
+            
+        }
+        
+    }
+    
+    if (tick == 0) {
+        
+        tick = (_currentTick | (SQDelayQueueWheelSpan - 1)) + 1;
+        
+    }
+    
+    uint64_t nanoseconds = tick * _tickNanoseconds + _origin;
+    uint64_t now = clock_gettime_nsec_np(CLOCK_MONOTONIC);
+    
+    return [NSDate dateWithTimeIntervalSinceNow:nanoseconds > now ? (NSTimeInterval)(nanoseconds - now) / NSEC_PER_SEC : 0];
+    
+}
+
+- (void)freeEntries:(SQDelayQueueEntry *)entry {
+    
+    while (entry) {
+        
+        SQDelayQueueEntry *next = entry->next;
+        CFRelease(entry->object);
+        free(entry);
+        entry = next;
+        
+    }
+    
+}
+
+@end
@@ -0,0 +1,126 @@
+//
+//  Pipeline.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+#import "PipelineStage.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A point-in-time report on a single pipeline stage
+ */
+@interface PipelineStageStatistics : NSObject
+
+/**
+ The name of the stage
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly, copy) NSString *name;
+
+/**
+ The number of objects the stage has taken from its input queue and processed
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) uint64_t processedCount;
+
+/**
+ The average number of objects processed per second since the pipeline started
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) double throughput;
+
+/**
+ The number of objects waiting in the stage's input queue
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger depth;
+
+/**
+ The total time the stage's workers have spent blocked because the next stage's input queue was full, summed across workers
+
+ @discussion A stage that stalls a lot is waiting on the stage after it. A stage whose input queue sits at capacity while the stage before it stalls is the bottleneck.
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSTimeInterval stallTime;
+
+/**
+ The total time spent blocked adding to the stage's input queue because it was full
+
+ @discussion For the first stage, this is the time spent in -submit: and -submitObjects:. For every other stage, it's the stall time of the stage before it.
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSTimeInterval inputStallTime;
+
+@end
+
+/**
+ A chain of stages connected by bounded queues, each stage run by its own pool of worker threads
+
+ @discussion Each stage takes batches of objects from its input queue, runs its block over them, and passes whatever the block returns to the next stage's input queue. When an input queue is full, whoever is adding to it blocks until there's room, so a slow stage backs up every stage before it and, ultimately, -submit:, instead of letting work pile up in memory.
+ */
+@interface Pipeline : NSObject
+
+/**
+ @name Initializers
+ */
+
+/**
+ Create a pipeline. Workers don't start until -start is called.
+
+ @param stages The stages, in order. Must not be empty.
+ @return The pipeline
+ */
+- (instancetype)initWithStages:(NSArray<PipelineStage *> *)stages NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ @name Running
+ */
+
+/**
+ Start every stage's worker threads. Calling this more than once has no effect.
+ */
+- (void)start;
+
+/**
+ Add an object to the first stage's input queue, blocking while it's full
+
+ @param object The object
+ */
+- (void)submit:(id)object;
+
+/**
+ Add objects to the first stage's input queue in order, blocking whenever it's full
+
+ @param objects The objects
+ */
+- (void)submitObjects:(NSArray *)objects;
+
+/**
+ Stop accepting objects. Each stage shuts down once it has drained its input queue and the stage before it has shut down.
+ */
+- (void)finish;
+
+/**
+ Block until every stage has shut down, after -finish
+ */
+- (void)waitUntilFinished;
+
+/**
+ @name Statistics
+ */
+
+/**
+ The stages, in order
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly, copy) NSArray<PipelineStage *> *stages;
+
+/**
+ A report on each stage, in order. Safe to read from any thread while the pipeline runs.
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSArray<PipelineStageStatistics *> *statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,424 @@
+//
+//  Pipeline.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "Pipeline.h"
+#import "Queue.h"
+
+#import <stdatomic.h>
+#import <time.h>
+
+/**
+ A bounded, blocking queue between two stages, which can be closed once nothing more will be added
+ */
+@interface SQPipelineChannel : NSObject {
+    
+    NSCondition *_condition;
+    Queue *_objects;
+    NSUInteger _capacity;
+    BOOL _closed;
+    uint64_t _blockedNanoseconds;
+    
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/**
+ Add an object, blocking while the channel is full
+ 
+ @param object The object
+ @return The time spent blocked, in nanoseconds
+ */
+- (uint64_t)put:(id)object;
+
+/**
+ Take up to a number of objects, blocking while the channel is empty and still open
+ 
+ @param count The most objects to take
+ @return The objects, or nil once the channel is closed and drained
+ */
+- (NSArray *)takeUpTo:(NSUInteger)count;
+
+- (void)close;
+
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ The total time everything adding to the channel has spent blocked, in nanoseconds
+ */
+@property (nonatomic, readonly) uint64_t blockedNanoseconds;
+
+@end
+
+@implementation SQPipelineChannel
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _condition = [[NSCondition alloc] init];
+        _objects = [Queue queue];
+        _capacity = capacity;
+        
+    }
+    
+    return self;
+    
+}
+
+- (uint64_t)put:(id)object {
+    
+    uint64_t waited = 0;
+    
+    [_condition lock];
+    
+    if (_objects.count >= _capacity && !_closed) {
+        
+        uint64_t start = clock_gettime_nsec_np(CLOCK_MONOTONIC);
+        
+        while (_objects.count >= _capacity && !_closed) {
+            
+            [_condition wait];
+            
+        }
+        
+        waited = clock_gettime_nsec_np(CLOCK_MONOTONIC) - start;
+        _blockedNanoseconds += waited;
+        
+    }
+    
+    if (_closed) {
+        
+        [_condition unlock];
+        [NSException raise:NSInternalInconsistencyException format:@"objects can't be submitted to a pipeline after it has finished"];
+        
+    }
+    
+    [_objects enqueue:object];
+    
+    [_condition broadcast];
+    [_condition unlock];
+    
+    return waited;
+    
+}
+
+- (NSArray *)takeUpTo:(NSUInteger)count {
+    
+    [_condition lock];
+    
+    while (_objects.count == 0 && !_closed) {
+        
+        [_condition wait];
+        
+    }
+    
+    NSUInteger length = MIN(count, _objects.count);
+    NSMutableArray *objects = nil;
+    
+    if (length > 0) {
+        
+        objects = [NSMutableArray arrayWithCapacity:length];
+        
+        for (NSUInteger i = 0; i < length; i++) {
+            
+            [objects addObject:[_objects dequeue]];
+            
+        }
+        
+        [_condition broadcast];
+        
+    }
+    
+    [_condition unlock];
+    
+    return objects;
+    
+}
+
+- (void)close {
+    
+    [_condition lock];
+    _closed = YES;
+    [_condition broadcast];
+    [_condition unlock];
+    
+}
+
+- (NSUInteger)count {
+    
+    [_condition lock];
+    NSUInteger count = _objects.count;
+    [_condition unlock];
+    
+    return count;
+    
+}
+
+- (uint64_t)blockedNanoseconds {
+    
+    [_condition lock];
+    uint64_t blocked = _blockedNanoseconds;
+    [_condition unlock];
+    
+    return blocked;
+    
+}
+
+@end
+
+/**
+ The running state of one stage
+ */
+@interface SQPipelineStageState : NSObject {
+    
+    @public
+    PipelineStage *_stage;
+    SQPipelineChannel *_input;
+    SQPipelineChannel *_output;
+    _Atomic(uint64_t) _processedCount;
+    _Atomic(NSUInteger) _runningWorkers;
+    
+}
+
+@end
+
+@implementation SQPipelineStageState
+
+@end
+
+@interface PipelineStageStatistics ()
+
++ (instancetype)statisticsWithName:(NSString *)name processedCount:(uint64_t)processedCount throughput:(double)throughput depth:(NSUInteger)depth stallTime:(NSTimeInterval)stallTime inputStallTime:(NSTimeInterval)inputStallTime;
+
+@end
+
+@implementation PipelineStageStatistics
+
+#pragma mark - Private Class Methods
+
++ (instancetype)statisticsWithName:(NSString *)name processedCount:(uint64_t)processedCount throughput:(double)throughput depth:(NSUInteger)depth stallTime:(NSTimeInterval)stallTime inputStallTime:(NSTimeInterval)inputStallTime {
+    
+    PipelineStageStatistics *statistics = [[self alloc] init];
+    statistics->_name = [name copy];
+    statistics->_processedCount = processedCount;
+    statistics->_throughput = throughput;
+    statistics->_depth = depth;
+    statistics->_stallTime = stallTime;
+    statistics->_inputStallTime = inputStallTime;
+    
+    return statistics;
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (NSString *)description {
+    
+    return [NSString stringWithFormat:@"<%@: %@; processed = %llu; throughput = %.1f/s; depth = %lu; stall = %.3fs; input stall = %.3fs>", NSStringFromClass([self class]), self.name, self.processedCount, self.throughput, (unsigned long)self.depth, self.stallTime, self.inputStallTime];
+    
+}
+
+@end
+
+@implementation Pipeline {
+    
+    NSArray<SQPipelineStageState *> *_states;
+    dispatch_group_t _workers;
+    _Atomic(uint64_t) _startTime;
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithStages:(NSArray<PipelineStage *> *)stages {
+    
+    if (stages.count == 0) {
+        
+        [NSException raise:NSInvalidArgumentException format:@"a pipeline needs at least one stage"];
+        
+    }
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _stages = [stages copy];
+        _workers = dispatch_group_create();
+        
+        NSMutableArray<SQPipelineStageState *> *states = [NSMutableArray arrayWithCapacity:stages.count];
+        SQPipelineChannel *input = [[SQPipelineChannel alloc] initWithCapacity:stages.firstObject.capacity];
+        
+        for (NSUInteger i = 0; i < stages.count; i++) {
+            
+            SQPipelineStageState *state = [[SQPipelineStageState alloc] init];
+            state->_stage = stages[i];
+            state->_input = input;
+            
+            // Each stage writes into the next stage's input queue, sized by the next stage
+            if (i + 1 < stages.count) {
+                
+                state->_output = [[SQPipelineChannel alloc] initWithCapacity:stages[i + 1].capacity];
+                
+            }
+            
+            input = state->_output;
+            [states addObject:state];
+            
+        }
+        
+        _states = states;
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Public Instance Methods
+
+- (void)start {
+    
+    uint64_t expected = 0;
+    
+    if (!atomic_compare_exchange_strong(&_startTime, &expected, clock_gettime_nsec_np(CLOCK_MONOTONIC)))
+        return;
+    
+    for (SQPipelineStageState *state in _states) {
+        
+        atomic_store(&state->_runningWorkers, state->_stage.parallelism);
+        
+        for (NSUInteger i = 0; i < state->_stage.parallelism; i++) {
+            
+            dispatch_group_enter(_workers);
+            
+            NSThread *thread = [[NSThread alloc] initWithBlock:^{
+                
+                @try {
+                    
+                    [Pipeline runWorkerForState:state];
+                    
+                } @finally {
+                    
+                    dispatch_group_leave(self->_workers);
+                    
+                }
+                
+            }];
+            
+            thread.name = [NSString stringWithFormat:@"Pipeline %@ %lu", state->_stage.name, (unsigned long)i];
+            [thread start];
+            
+        }
+        
+    }
+    
+}
+
+- (void)submit:(id)object {
+    
+    [_states.firstObject->_input put:object];
+    
+}
+
+- (void)submitObjects:(NSArray *)objects {
+    
+    SQPipelineChannel *input = _states.firstObject->_input;
+    
+    for (id object in objects) {
+        
+        [input put:object];
+        
+    }
+    
+}
+
+- (void)finish {
+    
+    [_states.firstObject->_input close];
+    
+}
+
+- (void)waitUntilFinished {
+    
+    dispatch_group_wait(_workers, DISPATCH_TIME_FOREVER);
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (NSArray<PipelineStageStatistics *> *)statistics {
+    
+    uint64_t startTime = atomic_load(&_startTime);
+    double elapsed = startTime ? (double)(clock_gettime_nsec_np(CLOCK_MONOTONIC) - startTime) / NSEC_PER_SEC : 0;
+    NSMutableArray<PipelineStageStatistics *> *statistics = [NSMutableArray arrayWithCapacity:_states.count];
+    
+    for (SQPipelineStageState *state in _states) {
+        
+        uint64_t processed = atomic_load_explicit(&state->_processedCount, memory_order_relaxed);
+        uint64_t stalled = state->_output.blockedNanoseconds;
+        
+        [statistics addObject:[PipelineStageStatistics statisticsWithName:state->_stage.name
+                                                           processedCount:processed
+                                                               throughput:elapsed > 0 ? processed / elapsed : 0
+                                                                    depth:state->_input.count
+                                                                stallTime:(NSTimeInterval)stalled / NSEC_PER_SEC
+                                                           inputStallTime:(NSTimeInterval)state->_input.blockedNanoseconds / NSEC_PER_SEC]];
+        
+    }
+    
+    return statistics;
+    
+}
+
+#pragma mark - Private Class Methods
+
++ (void)runWorkerForState:(SQPipelineStageState *)state {
+    
+    PipelineStage *stage = state->_stage;
+    PipelineStageBlock block = stage.block;
+    NSArray *batch;
+    
+    @try {
+        
+        while ((batch = [state->_input takeUpTo:stage.batchSize])) {
+            
+            @autoreleasepool {
+                
+                NSArray *outputs = block(batch);
+                atomic_fetch_add_explicit(&state->_processedCount, batch.count, memory_order_relaxed);
+                
+                if (state->_output) {
+                    
+                    for (id output in outputs) {
+                        
+                        [state->_output put:output];
+                        
+                    }
+                    
+                }
+                
+            }
+            
+        }
+        
+    } @finally {
+        
+        // The last worker out closes the next stage's input, so shutdown flows down the pipeline, even if a block threw
+        if (atomic_fetch_sub(&state->_runningWorkers, 1) == 1) {
+            
+            [state->_output close];
+            
+        }
+        
+    }
+    
+}
+
+@end
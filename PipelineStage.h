@@ -0,0 +1,92 @@
+//
+//  PipelineStage.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The work done by a pipeline stage on a batch of objects
+
+ @param batch Between one and `batchSize` objects taken from the stage's input queue, in order
+ @return The objects to pass on to the next stage, or nil to pass on nothing. Ignored for the last stage.
+ @warning The block must not throw. An exception escaping it ends the worker's thread like any uncaught exception, though the worker still checks out of the pipeline on the way, so a caller that catches it isn't left waiting in -waitUntilFinished.
+ */
+typedef NSArray * _Nullable (^PipelineStageBlock)(NSArray *batch);
+
+/**
+ A description of a single stage in a Pipeline
+ */
+@interface PipelineStage : NSObject
+
+/**
+ @name Factory Methods
+ */
+
+/**
+ Create a stage
+
+ @param name A name for the stage, used in statistics
+ @param parallelism The number of worker threads that run the block concurrently. Must be at least 1.
+ @param batchSize The most objects handed to the block at once. Must be at least 1.
+ @param capacity The most objects the stage's input queue holds before producers upstream block. Must be at least 1.
+ @param block The work the stage does
+ @return The stage
+ */
++ (instancetype)stageWithName:(NSString *)name parallelism:(NSUInteger)parallelism batchSize:(NSUInteger)batchSize capacity:(NSUInteger)capacity block:(PipelineStageBlock)block;
+
+/**
+ @name Initializers
+ */
+
+/**
+ Create a stage
+
+ @param name A name for the stage, used in statistics
+ @param parallelism The number of worker threads that run the block concurrently. Must be at least 1.
+ @param batchSize The most objects handed to the block at once. Must be at least 1.
+ @param capacity The most objects the stage's input queue holds before producers upstream block. Must be at least 1.
+ @param block The work the stage does
+ @return The stage
+ */
+- (instancetype)initWithName:(NSString *)name parallelism:(NSUInteger)parallelism batchSize:(NSUInteger)batchSize capacity:(NSUInteger)capacity block:(PipelineStageBlock)block NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ @name Configuration
+ */
+
+/**
+ The name of the stage
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly, copy) NSString *name;
+
+/**
+ The number of worker threads that run the block concurrently
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger parallelism;
+
+/**
+ The most objects handed to the block at once
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger batchSize;
+
+/**
+ The most objects the stage's input queue holds
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger capacity;
+
+/**
+ The work the stage does
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly, copy) PipelineStageBlock block;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,59 @@
+//
+//  PipelineStage.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "PipelineStage.h"
+
+@implementation PipelineStage
+
+#pragma mark - Public Class Methods
+
++ (instancetype)stageWithName:(NSString *)name parallelism:(NSUInteger)parallelism batchSize:(NSUInteger)batchSize capacity:(NSUInteger)capacity block:(PipelineStageBlock)block {
+    
+    return [[self alloc] initWithName:name
+                          parallelism:parallelism
+                            batchSize:batchSize
+                             capacity:capacity
+                                block:block];
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (NSString *)description {
+    
+    return [NSString stringWithFormat:@"<%@: %@; parallelism = %lu; batchSize = %lu; capacity = %lu>", NSStringFromClass([self class]), self.name, (unsigned long)self.parallelism, (unsigned long)self.batchSize, (unsigned long)self.capacity];
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithName:(NSString *)name parallelism:(NSUInteger)parallelism batchSize:(NSUInteger)batchSize capacity:(NSUInteger)capacity block:(PipelineStageBlock)block {
+    
+    if (parallelism == 0 || batchSize == 0 || capacity == 0) {
+        
+        [NSException raise:NSInvalidArgumentException format:@"a pipeline stage needs a parallelism, batch size and capacity of at least 1"];
+        
+    }
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _name = [name copy];
+        _parallelism = parallelism;
+        _batchSize = batchSize;
+        _capacity = capacity;
+        _block = [block copy];
+        
+    }
+    
+    return self;
+    
+}
+
+@end
@@ -8,10 +8,56 @@
 
 @import Foundation;
 
+#import "Queueing.h"
+#import "StackQueueChange.h"
+#import "SQBinaryCodec.h"
+#import "QueueSnapshot.h"
+#import "SQChunkedBuffer.h"
+
+#import <os/lock.h>
+
+#ifndef SQQueueInlineCapacity
+/**
+ The number of objects every queue stores inside the instance itself, unless it's allocated with +allocWithInlineCapacity:. Define it in the build settings to give every queue inline storage.
+ */
+#define SQQueueInlineCapacity 0
+#endif
+
+/**
+ The operations the inline queue functions may perform directly on an instance
+ */
+typedef NS_OPTIONS(uint32_t, SQQueueFastPath) {
+
+    SQQueueFastPathEnqueue = 1 << 0,
+    SQQueueFastPathDequeue = 1 << 1,
+    SQQueueFastPathPeek = 1 << 2,
+    SQQueueFastPathCount = 1 << 3
+
+};
+
 /**
- A FIFO Queue in Objective-C, backed by an NSArray
+ A FIFO Queue in Objective-C, backed by chunked copy-on-write storage
  */
-@interface Queue<__covariant ObjectType> : NSObject<NSSecureCoding, NSCopying, NSFastEnumeration>
+@interface Queue<__covariant ObjectType> : NSObject<Queueing, NSSecureCoding, NSCopying, NSFastEnumeration> {
+
+    @public
+
+    /**
+     Private. The queue's storage, exposed only for the inline functions below.
+     */
+    SQChunkedBuffer _buffer;
+
+    /**
+     Private. Guards the storage against concurrent enqueues and dequeues.
+     */
+    os_unfair_lock _bufferLock;
+
+    /**
+     Private. The SQQueueFastPath operations the inline functions may perform directly, which only changes with the lock held. An operation is excluded while the class overrides its method, or while change observers or waiting dequeues need to see it.
+     */
+    uint32_t _fastPaths;
+
+}
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -59,6 +105,22 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (nullable instancetype)queueWithArray:(NSArray<ObjectType> *)array;
 
+/**
+ Create an empty queue that stores up to a number of objects inside the instance itself, and only allocates storage once it holds more than that
+
+ @param capacity The number of objects to store inline
+ @return The queue
+ */
++ (nullable instancetype)queueWithInlineCapacity:(NSUInteger)capacity;
+
+/**
+ Allocate a queue with room for a number of objects inside the instance itself, to be initialized with any initializer. Queues allocated with +alloc get SQQueueInlineCapacity objects of inline storage.
+
+ @param capacity The number of objects to store inline
+ @return The uninitialized queue
+ */
++ (instancetype)allocWithInlineCapacity:(NSUInteger)capacity;
+
 /**
  @name Initializers
  */
@@ -88,6 +150,26 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable instancetype)initWithObjects:(ObjectType const *)objects count:(NSUInteger)cnt;
 
+/**
+ Create a queue that takes over a C array of objects, without copying it
+
+ @discussion The queue adopts both the storage and the reference it holds to each object, so the objects must be retained (as they are in a `__strong id *` buffer) and the caller must not release them or use the buffer afterwards.
+ @param objects The C array
+ @param cnt The length of the C array
+ @param freeWhenDone YES if the C array was allocated with malloc and the queue should free it, NO if the caller keeps the memory alive for the lifetime of the queue
+ @return The queue
+ */
+- (nullable instancetype)initWithObjectsNoCopy:(__strong ObjectType *)objects count:(NSUInteger)cnt freeWhenDone:(BOOL)freeWhenDone;
+
+/**
+ Create a queue with the contents of a mutable array, and empty the array
+
+ @discussion This is a move, not a no-copy adoption: the objects are copied into the queue's own storage in a single bulk O(n) pass, and then removed from the array. To take over storage without copying it, use -initWithObjectsNoCopy:count:freeWhenDone:.
+ @param array The mutable array
+ @return The queue
+ */
+- (nullable instancetype)initByMovingObjectsFromArray:(NSMutableArray<ObjectType> *)array;
+
 /**
  Create a stack with an NSArray
  
@@ -117,17 +199,50 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  View the item in the front of the queue
 
- @return The item at the front of the queue
+ @return The item at the front of the queue, or nil if the queue is empty
  */
 - (nullable ObjectType)peek;
 
 /**
  Dequeue an item from the front of the queue
 
- @return The item
+ @return The item, or nil if the queue is empty
  */
 - (nullable ObjectType)dequeue;
 
+/**
+ @name Asynchronous Dequeue
+ */
+
+/**
+ Dequeue an item from the front of the queue without blocking, calling a completion once one is available
+
+ @discussion If the queue is empty, the request is parked as a continuation instead of a sleeping thread, and the next -enqueue: hands its object straight to the oldest waiting request, so any number of consumers can wait without tying up threads. Waiting requests are fulfilled strictly in the order they were made. Objects handed directly to a request never appear in the queue, so they aren't reported to change observers.
+ @param queue The dispatch queue to call the completion on
+ @param completion The completion, called exactly once unless the request is cancelled, or the queue is deallocated first
+ @return A token that can be passed to -cancelDequeue:
+ */
+- (id<NSObject>)dequeueAsyncOnQueue:(dispatch_queue_t)queue completion:(void (^)(ObjectType _Nullable object))completion;
+
+/**
+ Dequeue up to a number of items from the front of the queue without blocking, calling a completion as soon as at least one is available
+
+ @discussion Waiting batched requests share the same first-come, first-served order as -dequeueAsyncOnQueue:completion:. An -enqueueObjects: fills each waiting request in turn, up to its limit, before anything is added to the queue.
+ @param count The most items to dequeue. Must be at least 1.
+ @param queue The dispatch queue to call the completion on
+ @param completion The completion, called exactly once with between 1 and `count` items, unless the request is cancelled, or the queue is deallocated first
+ @return A token that can be passed to -cancelDequeue:
+ */
+- (id<NSObject>)dequeueUpTo:(NSUInteger)count onQueue:(dispatch_queue_t)queue completion:(void (^)(NSArray<ObjectType> *objects))completion;
+
+/**
+ Cancel an asynchronous dequeue that is still waiting for objects
+
+ @param token The token returned by -dequeueAsyncOnQueue:completion: or -dequeueUpTo:onQueue:completion:
+ @return YES if the request was waiting and its completion will never be called, otherwise NO, because it has already been fulfilled, or the token didn't come from this queue.
+ */
+- (BOOL)cancelDequeue:(id<NSObject>)token;
+
 /**
  @name Equality & Content Checking
  */
@@ -350,6 +465,35 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSEnumerator *)objectEnumerator;
 
+/**
+ @name Removing Objects
+ */
+
+/**
+ Remove every object that passes a test, closing up the rest in place in a single pass
+
+ @discussion Every object is tested first, with the queue unlocked, and the queue is only locked to close up the survivors, so snapshots taken from other threads aren't held up by the test. The test must not mutate the queue: if it does, an NSGenericException is raised and nothing is removed. The results take a byte per object, in storage the queue keeps between calls, so purging a queue regularly doesn't allocate once that storage is big enough. The exception is a queue that shares its storage with a copy or a snapshot: its survivors are copied into storage of its own.
+ @param predicate The test to apply to each object
+ @return The number of objects removed
+ */
+- (NSUInteger)removeObjectsPassingTest:(BOOL (^)(ObjectType obj, NSUInteger idx, BOOL *stop))predicate;
+
+/**
+ Remove every object that passes a test, closing up the rest in place
+
+ @param opts NSEnumerationConcurrent evaluates an expensive test for every object in parallel before the queue is compacted. Setting stop is then best-effort: objects that other threads had already tested may still be removed. Other options are ignored.
+ @param predicate The test to apply to each object. With NSEnumerationConcurrent it must be safe to call from any thread.
+ @return The number of objects removed
+ */
+- (NSUInteger)removeObjectsWithOptions:(NSEnumerationOptions)opts passingTest:(BOOL (^)(ObjectType obj, NSUInteger idx, BOOL *stop))predicate;
+
+/**
+ Keep only the objects that match a predicate, in place
+
+ @param predicate The predicate
+ */
+- (void)filterUsingPredicate:(NSPredicate *)predicate;
+
 /**
  @name Deriving Queues
  */
@@ -511,6 +655,86 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSString *)componentsJoinedByString:(NSString *)separator;
 
+/**
+ @name Binary Coding
+ */
+
+/**
+ Write the queue to a stream in a compact, length-prefixed binary format, much faster and smaller than keyed archiving
+
+ @discussion Strings, numbers and data objects are written directly. Any other object is archived with secure coding, and must support it. Objects are written front to back, through a fixed-size buffer.
+ @param stream The stream. It is opened if it isn't already, and left open.
+ @param error The error, if the stream failed or an object couldn't be encoded
+ @return YES if the queue was written, otherwise NO.
+ */
+- (BOOL)writeToStream:(NSOutputStream *)stream error:(NSError **)error;
+
+/**
+ Enqueue objects read from a stream written by -writeToStream:error:, as they're read
+
+ @discussion The stream is read through a fixed-size buffer and objects are enqueued in batches as they're decoded, so even very large dumps load in bounded memory beyond the objects themselves. If decoding fails part way, the objects read before the failure stay enqueued.
+ @param stream The stream. It is opened if it isn't already, and left open.
+ @param allowedClasses The classes archived objects may decode as. Strings, numbers and data objects are always allowed.
+ @param error The error, if the stream failed or didn't hold valid data
+ @return YES if the whole stream was read, otherwise NO.
+ */
+- (BOOL)enqueueObjectsFromStream:(NSInputStream *)stream allowedClasses:(NSSet<Class> *)allowedClasses error:(NSError **)error;
+
+/**
+ @name Key-Value Coding
+ */
+
+/**
+ Extract the value for a key from every object in the queue into a buffer of 64-bit integers, without boxing
+
+ @discussion The getter (or instance variable) for the key is resolved once per class and reused for every object of that class. Scalar properties are read directly; object properties are converted with -longLongValue; nil values become 0.
+ @param key The key
+ @param buffer The buffer, which must have room for `count` values
+ */
+- (void)int64ValuesForKey:(NSString *)key into:(int64_t *)buffer;
+
+/**
+ Extract the value for a key from every object in the queue into a buffer of doubles, without boxing
+
+ @discussion The getter (or instance variable) for the key is resolved once per class and reused for every object of that class. Scalar properties are read directly; object properties are converted with -doubleValue; nil values become 0.
+ @param key The key
+ @param buffer The buffer, which must have room for `count` values
+ */
+- (void)doubleValuesForKey:(NSString *)key into:(double *)buffer;
+
+/**
+ @name Snapshots
+ */
+
+/**
+ Take an immutable, point-in-time view of the queue, in O(1)
+
+ @discussion The snapshot shares storage with the queue copy-on-write. While it's alive, the queue only copies the chunks of storage it actually modifies, so enqueueing and dequeueing stay cheap. This method may be called from any thread, and the snapshot may be read from any thread, while the queue continues to be mutated.
+ @return The snapshot
+ */
+- (QueueSnapshot<ObjectType> *)snapshot;
+
+/**
+ @name Observing Changes
+ */
+
+/**
+ Observe changes to the queue itself, as coalesced batches of change records
+
+ @discussion Queues are not KVO compliant. Instead, every mutation is recorded and coalesced until `queue` drains, then delivered as a single batch: ten thousand objects enqueued before the block runs arrive as one insertion. Each record in a batch is expressed in terms of the contents after the records before it have been applied.
+ @param queue The dispatch queue to deliver changes on. Changes are coalesced per drain of this queue, so use the main queue to coalesce per run loop turn.
+ @param block The block to deliver changes to
+ @return An opaque observer, to pass to -removeChangeObserver:
+ */
+- (id<NSObject>)addChangeObserverOnQueue:(dispatch_queue_t)queue usingBlock:(void (^)(NSArray<StackQueueChange *> *changes))block;
+
+/**
+ Stop observing changes to the queue. Changes that have been recorded but not yet delivered are discarded.
+
+ @param observer The observer returned by -addChangeObserverOnQueue:usingBlock:
+ */
+- (void)removeChangeObserver:(id<NSObject>)observer;
+
 /**
  @name Key-Value Observation
  */
@@ -538,3 +762,83 @@ NS_ASSUME_NONNULL_BEGIN
 NS_ASSUME_NONNULL_END
 
 @end
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @name Inline Functions
+ */
+
+/**
+ Enqueue an object, without a message send when the queue allows it. Equivalent to -enqueue:.
+
+ @param queue The queue
+ @param object The object
+ */
+NS_INLINE void SQQueueEnqueue(Queue *queue, id object) {
+
+    os_unfair_lock_lock(&queue->_bufferLock);
+
+    if (queue->_fastPaths & SQQueueFastPathEnqueue) {
+
+        SQChunkedBufferAppend(&queue->_buffer, object);
+        os_unfair_lock_unlock(&queue->_bufferLock);
+        return;
+
+    }
+
+    os_unfair_lock_unlock(&queue->_bufferLock);
+    [queue enqueue:object];
+
+}
+
+/**
+ Dequeue an object, without a message send when the queue allows it. Equivalent to -dequeue.
+
+ @param queue The queue
+ @return The item formerly at the front of the queue
+ */
+NS_INLINE id _Nullable SQQueueDequeue(Queue *queue) {
+
+    if (!(queue->_fastPaths & SQQueueFastPathDequeue))
+        return [queue dequeue];
+
+    os_unfair_lock_lock(&queue->_bufferLock);
+    id object = SQChunkedBufferRemoveFirst(&queue->_buffer);
+    os_unfair_lock_unlock(&queue->_bufferLock);
+
+    return object;
+
+}
+
+/**
+ View the item at the front of the queue, without a message send when the queue allows it. Equivalent to -peek.
+
+ @param queue The queue
+ @return The item at the front of the queue
+ */
+NS_INLINE id _Nullable SQQueuePeek(Queue *queue) {
+
+    if (queue->_fastPaths & SQQueueFastPathPeek)
+        return queue->_buffer.count > 0 ? SQChunkedBufferObjectAtIndex(&queue->_buffer, 0) : nil;
+
+    return [queue peek];
+
+}
+
+/**
+ The number of items in the queue, without a message send when the queue allows it. Equivalent to -count.
+
+ @param queue The queue
+ @return The number of items
+ */
+NS_INLINE NSUInteger SQQueueCount(Queue *queue) {
+
+    if (queue->_fastPaths & SQQueueFastPathCount)
+        return queue->_buffer.count;
+
+    return queue.count;
+
+}
+
+NS_ASSUME_NONNULL_END
@@ -7,6 +7,14 @@
 //
 
 #import "Queue.h"
+#import "SQKeyValueAccessor.h"
+#import "SQChangeObserver.h"
+#import "SQDequeueRequest.h"
+#import "SQMethodOverrides.h"
+#import "SQConcurrentTest.h"
+#import "QueueSnapshot+Private.h"
+
+#import <objc/runtime.h>
 
 @interface QueueEnumerator : NSEnumerator {
     
@@ -46,9 +54,94 @@
 
 @end
 
-@interface Queue<ObjectType> ()
+/**
+ A read-only NSArray over a queue's buffer, so the NSArray algorithms can run on the queue without copying it first. It reads the queue live, so it must not outlive a read-only operation.
+ */
+@interface QueueArrayView : NSArray {
+    
+    Queue *_queue;
+    
+}
+
+- (instancetype)initWithQueue:(Queue *)queue;
+
+@end
+
+@implementation QueueArrayView
+
+- (instancetype)initWithQueue:(Queue *)queue {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _queue = queue;
+        
+    }
+    
+    return self;
+    
+}
+
+- (NSUInteger)count {
+    
+    return _queue->_buffer.count;
+    
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    
+    return [_queue objectAtIndex:index];
+    
+}
+
+- (void)getObjects:(id  _Nonnull __unsafe_unretained [])objects range:(NSRange)range {
+    
+    if (NSMaxRange(range) > _queue->_buffer.count) {
+        
+        [NSException raise:NSRangeException format:@"range %@ beyond bounds for queue of count %lu", NSStringFromRange(range), (unsigned long)_queue->_buffer.count];
+        
+    }
+    
+    for (NSUInteger i = 0; i < range.length; i++) {
+        
+        objects[i] = SQChunkedBufferObjectAtIndex(&_queue->_buffer, range.location + i);
+        
+    }
+    
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id  _Nullable __unsafe_unretained [])buffer count:(NSUInteger)len {
+    
+    return SQChunkedBufferEnumerate(&_queue->_buffer, state);
+    
+}
+
+@end
+
+@interface Queue<ObjectType> () {
+    
+    NSMutableArray<SQChangeObserver *> *_changeObservers;
+    
+    // The SQQueueFastPath operations whose methods the class doesn't override
+    uint32_t _inheritedFastPaths;
+    
+    // Storage for the first objects, allocated along with the instance by +allocWithInlineCapacity:
+    const void **_inlineObjects;
+    NSUInteger _inlineCapacity;
+    
+    // Asynchronous dequeues waiting for objects, oldest first. There are only ever waiting requests while the buffer is empty.
+    SQDequeueRequest *_firstRequest;
+    SQDequeueRequest *_lastRequest;
+    
+    // Results for -removeObjectsWithOptions:passingTest:, kept so regular purges don't allocate
+    SQTestResults _testResults;
+    
+}
+
+@property (nonatomic, readonly) NSArray<ObjectType> *internalArray;
 
-@property (nonatomic, copy) NSArray<ObjectType> *internalArray;
+- (instancetype)initWithFirstObject:(id)firstObj arguments:(va_list)args;
 
 @end
 
@@ -70,17 +163,12 @@
 
 + (instancetype)queueWithObjects:(id)firstObj, ... {
     
-    NSArray *objects = @[];
     va_list args;
     va_start(args, firstObj);
+    Queue *queue = [[self alloc] initWithFirstObject:firstObj arguments:args];
+    va_end(args);
     
-    for (id arg = firstObj; arg != nil; arg = va_arg(args, id)) {
-        
-        objects = [objects arrayByAddingObject:arg];
-        
-    }
-    
-    return [self queueWithArray:objects];
+    return queue;
     
 }
 
@@ -96,6 +184,38 @@
     
 }
 
++ (instancetype)queueWithInlineCapacity:(NSUInteger)capacity {
+    
+    return [[self allocWithInlineCapacity:capacity] init];
+    
+}
+
++ (instancetype)allocWithInlineCapacity:(NSUInteger)capacity {
+    
+    Queue *queue = class_createInstance(self, capacity * sizeof(void *));
+    
+    if (queue && capacity > 0) {
+        
+        // The extra bytes sit straight after the instance's ivars
+        queue->_inlineObjects = (const void **)(void *)((uint8_t *)(__bridge void *)queue + class_getInstanceSize(self));
+        queue->_inlineCapacity = capacity;
+        
+    }
+    
+    return queue;
+    
+}
+
+#if SQQueueInlineCapacity > 0
+
++ (instancetype)allocWithZone:(struct _NSZone *)zone {
+    
+    return [self allocWithInlineCapacity:SQQueueInlineCapacity];
+    
+}
+
+#endif
+
 #pragma mark - Overridden Instance Methods
 
 - (instancetype)init {
@@ -106,9 +226,23 @@
     
 }
 
+- (void)dealloc {
+    
+    SQChunkedBufferDestroy(&_buffer);
+    SQTestResultsDestroy(&_testResults);
+    
+    // Unlink abandoned requests one at a time, rather than letting a long list release itself recursively
+    while (_firstRequest) {
+        
+        [self removeFirstRequest];
+        
+    }
+    
+}
+
 - (NSUInteger)hash {
     
-    return self.internalArray.hash;
+    return self.count;
     
 }
 
@@ -154,13 +288,19 @@
 
 - (void)setValue:(id)value forKey:(NSString *)key {
     
-    [self.internalArray setValue:value forKey:key];
+    SQSetValueForKey(self, value, key);
     
 }
 
 - (id)valueForKey:(NSString *)key {
     
-    return [self.internalArray valueForKey:key];
+    if ([key hasPrefix:@"@"]) {
+        
+        return [self.internalArray valueForKey:key];
+        
+    }
+    
+    return SQValuesForKey(self, self.count, key);
     
 }
 
@@ -168,7 +308,14 @@
 
 - (NSUInteger)count {
     
-    return self.internalArray.count;
+    return _buffer.count;
+    
+}
+
+- (NSArray *)internalArray {
+    
+    // A view rather than a copy, so read-only methods that go through NSArray stay as cheap as they'd be on an array
+    return [[QueueArrayView alloc] initWithQueue:self];
     
 }
 
@@ -188,7 +335,8 @@
 
 - (void)encodeWithCoder:(NSCoder *)aCoder {
     
-    [aCoder encodeObject:self.internalArray forKey:NSStringFromSelector(@selector(internalArray))];
+    // Archive a real array, so it decodes as one
+    [aCoder encodeObject:SQChunkedBufferCopyArray(&_buffer) forKey:NSStringFromSelector(@selector(internalArray))];
     
 }
 
@@ -198,7 +346,7 @@
     
     if (self) {
         
-        _internalArray = [aDecoder decodeObjectOfClass:[NSArray class] forKey:NSStringFromSelector(@selector(internalArray))];
+        SQChunkedBufferAppendArray(&_buffer, [aDecoder decodeObjectOfClass:[NSArray class] forKey:NSStringFromSelector(@selector(internalArray))]);
         
     }
     
@@ -210,8 +358,28 @@
 
 - (id)copyWithZone:(NSZone *)zone {
     
-    Queue *copy = [[[self class] alloc] init];
-    copy->_internalArray = [self.internalArray copyWithZone:zone];
+    Queue *copy = [[[self class] allocWithInlineCapacity:_inlineCapacity] init];
+    
+    os_unfair_lock_lock(&_bufferLock);
+    
+    if (_buffer.index) {
+        
+        // Share storage copy-on-write, so copying is O(1) and each queue only copies what it later touches
+        SQChunkedBufferDestroy(&copy->_buffer);
+        SQChunkedBufferInitWithBuffer(&copy->_buffer, &_buffer);
+        
+    } else {
+        
+        // Our objects are still inline, so they fit in the copy's inline storage too
+        for (NSUInteger i = 0; i < _buffer.count; i++) {
+            
+            SQChunkedBufferAppend(&copy->_buffer, SQChunkedBufferObjectAtIndex(&_buffer, i));
+            
+        }
+        
+    }
+    
+    os_unfair_lock_unlock(&_bufferLock);
     
     return copy;
     
@@ -221,9 +389,7 @@
 
 - (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id  _Nullable __unsafe_unretained [])buffer count:(NSUInteger)len {
     
-    return [self.internalArray countByEnumeratingWithState:state
-                                                   objects:buffer
-                                                     count:len];
+    return SQChunkedBufferEnumerate(&_buffer, state);
     
 }
 
@@ -241,33 +407,58 @@
 
 - (instancetype)initWithObjects:(id)firstObj, ... {
     
-    NSArray *objects = @[];
     va_list args;
     va_start(args, firstObj);
+    self = [self initWithFirstObject:firstObj arguments:args];
+    va_end(args);
     
-    for (id arg = firstObj; arg != nil; arg = va_arg(args, id)) {
+    return self;
+    
+}
+
+- (instancetype)initWithObjects:(id  _Nonnull const __autoreleasing *)objects count:(NSUInteger)cnt {
+    
+    self = [self initWithArray:@[]];
+    
+    if (self) {
         
-        objects = [objects arrayByAddingObject:arg];
+        for (NSUInteger i = 0; i < cnt; i++) {
+            
+            SQChunkedBufferAppend(&_buffer, objects[i]);
+            
+        }
         
     }
     
-    self = [self initWithArray:objects];
-    
     return self;
     
 }
 
-- (instancetype)initWithObjects:(id  _Nonnull const __autoreleasing *)objects count:(NSUInteger)cnt {
+- (instancetype)initWithObjectsNoCopy:(__strong id *)objects count:(NSUInteger)cnt freeWhenDone:(BOOL)freeWhenDone {
     
-    NSArray *objs = @[];
+    self = [self initWithArray:@[]];
     
-    for (int i = 0; i < cnt; i++) {
+    if (self) {
         
-        objs = [objs arrayByAddingObject:objects[i]];
+        // Chunks become windows onto the C array, references and all
+        SQChunkedBufferDestroy(&_buffer);
+        SQChunkedBufferInitNoCopy(&_buffer, (const void **)(void *)objects, cnt, freeWhenDone);
         
     }
     
-    self = [self initWithArray:objs];
+    return self;
+    
+}
+
+- (instancetype)initByMovingObjectsFromArray:(NSMutableArray *)array {
+    
+    self = [self initWithArray:array];
+    
+    if (self) {
+        
+        [array removeAllObjects];
+        
+    }
     
     return self;
     
@@ -279,7 +470,18 @@
     
     if (self) {
         
-        self.internalArray = array;
+        _bufferLock = OS_UNFAIR_LOCK_INIT;
+        
+        if (_inlineCapacity > 0)
+            SQChunkedBufferInitWithInlineStorage(&_buffer, _inlineObjects, _inlineCapacity);
+        else
+            SQChunkedBufferInit(&_buffer);
+        
+        SQChunkedBufferAppendArray(&_buffer, array);
+        
+        static const SEL selectors[] = { @selector(enqueue:), @selector(dequeue), @selector(peek), @selector(count) };
+        _inheritedFastPaths = SQInheritedMethodMask(object_getClass(self), [Queue class], selectors, 4);
+        [self updateFastPaths];
         
     }
     
@@ -291,40 +493,270 @@
 
 - (void)enqueue:(id)object {
     
-    _internalArray = [self.internalArray arrayByAddingObject:object];
+    os_unfair_lock_lock(&_bufferLock);
+    
+    NSUInteger previousCount = _buffer.count;
+    
+    // Hand the object straight to the oldest waiting request, if there is one
+    SQDequeueRequest *request = [self removeFirstRequest];
+    
+    if (!request) {
+        
+        SQChunkedBufferAppend(&_buffer, object);
+        
+    }
+    
+    os_unfair_lock_unlock(&_bufferLock);
+    
+    if (request) {
+        
+        [request fulfillWithObjects:@[object]];
+        return;
+        
+    }
+    
+    [self recordInsertionOfCount:1 previousCount:previousCount];
     
 }
 
 - (void)enqueueObjects:(NSArray *)objects {
     
-    for (id object in objects) {
+    NSUInteger count = objects.count;
+    NSUInteger offset = 0;
+    NSMutableArray<SQDequeueRequest *> *requests = nil;
+    
+    os_unfair_lock_lock(&_bufferLock);
+    
+    NSUInteger previousCount = _buffer.count;
+    
+    if (_firstRequest) {
+        
+        // Share the objects out between waiting requests in the order they arrived, and only buffer what's left over
+        requests = [NSMutableArray array];
+        
+        while (_firstRequest && offset < count) {
+            
+            SQDequeueRequest *request = [self removeFirstRequest];
+            [requests addObject:request];
+            offset += MIN(request.maximumCount, count - offset);
+            
+        }
         
-        [self queueByEnqueueing:object];
+        for (NSUInteger i = offset; i < count; i++) {
+            
+            SQChunkedBufferAppend(&_buffer, objects[i]);
+            
+        }
+        
+    } else {
+        
+        SQChunkedBufferAppendArray(&_buffer, objects);
         
     }
     
+    os_unfair_lock_unlock(&_bufferLock);
+    
+    NSUInteger location = 0;
+    
+    for (SQDequeueRequest *request in requests) {
+        
+        NSUInteger length = MIN(request.maximumCount, offset - location);
+        [request fulfillWithObjects:[objects subarrayWithRange:NSMakeRange(location, length)]];
+        location += length;
+        
+    }
+    
+    [self recordInsertionOfCount:count - offset previousCount:previousCount];
+    
 }
 
 - (id)peek {
     
-    return self.internalArray.firstObject;
+    return _buffer.count > 0 ? SQChunkedBufferObjectAtIndex(&_buffer, 0) : nil;
     
 }
 
 - (id)dequeue {
     
-    id firstObj = [self peek];
-    _internalArray = [self.internalArray subarrayWithRange:NSMakeRange(1, self.internalArray.count - 1)];
+    os_unfair_lock_lock(&_bufferLock);
+    NSUInteger previousCount = _buffer.count;
+    id firstObj = SQChunkedBufferRemoveFirst(&_buffer);
+    os_unfair_lock_unlock(&_bufferLock);
+    
+    if (!firstObj) {
+        
+        return nil;
+        
+    }
+    
+    [self recordRemovalOfCount:1 previousCount:previousCount];
     
     return firstObj;
     
 }
 
+#pragma mark - Asynchronous Dequeue
+
+- (id<NSObject>)dequeueAsyncOnQueue:(dispatch_queue_t)queue completion:(void (^)(id _Nullable))completion {
+    
+    return [self dequeueUpTo:1
+                     onQueue:queue
+                  completion:^(NSArray *objects) {
+                      
+                      completion(objects.firstObject);
+                      
+                  }];
+    
+}
+
+- (id<NSObject>)dequeueUpTo:(NSUInteger)count onQueue:(dispatch_queue_t)queue completion:(void (^)(NSArray * _Nonnull))completion {
+    
+    if (count == 0) {
+        
+        [NSException raise:NSInvalidArgumentException format:@"an asynchronous dequeue must accept at least one object"];
+        
+    }
+    
+    SQDequeueRequest *request = [[SQDequeueRequest alloc] initWithQueue:queue
+                                                           maximumCount:count
+                                                             completion:completion];
+    request.owner = self;
+    NSArray *objects = nil;
+    
+    os_unfair_lock_lock(&_bufferLock);
+    
+    NSUInteger previousCount = _buffer.count;
+    
+    if (previousCount > 0) {
+        
+        NSUInteger length = MIN(count, previousCount);
+        NSMutableArray *removed = [NSMutableArray arrayWithCapacity:length];
+        
+        for (NSUInteger i = 0; i < length; i++) {
+            
+            [removed addObject:SQChunkedBufferRemoveFirst(&_buffer)];
+            
+        }
+        
+        objects = removed;
+        
+    } else {
+        
+        [self appendRequest:request];
+        
+    }
+    
+    os_unfair_lock_unlock(&_bufferLock);
+    
+    if (objects) {
+        
+        [request fulfillWithObjects:objects];
+        [self recordRemovalOfCount:objects.count previousCount:previousCount];
+        
+    }
+    
+    return request;
+    
+}
+
+- (BOOL)cancelDequeue:(id<NSObject>)token {
+    
+    // Only unlink our own requests, since another queue's list is guarded by its own lock
+    if (![token isKindOfClass:[SQDequeueRequest class]] || ((SQDequeueRequest *)token).owner != self)
+        return NO;
+    
+    SQDequeueRequest *request = (SQDequeueRequest *)token;
+    
+    os_unfair_lock_lock(&_bufferLock);
+    
+    BOOL pending = request.pending;
+    
+    if (pending) {
+        
+        [self unlinkRequest:request];
+        
+    }
+    
+    os_unfair_lock_unlock(&_bufferLock);
+    
+    return pending;
+    
+}
+
+#pragma mark - Removing Objects
+
+- (NSUInteger)removeObjectsPassingTest:(BOOL (^)(id _Nonnull, NSUInteger, BOOL * _Nonnull))predicate {
+    
+    return [self removeObjectsWithOptions:0 passingTest:predicate];
+    
+}
+
+- (NSUInteger)removeObjectsWithOptions:(NSEnumerationOptions)opts passingTest:(BOOL (^)(id _Nonnull, NSUInteger, BOOL * _Nonnull))predicate {
+    
+    NSUInteger count = _buffer.count;
+    
+    if (count == 0)
+        return 0;
+    
+    // Run the test before locking, so it can't deadlock against the queue or hold up snapshots. Only this thread mutates the buffer, so reading it unlocked is safe.
+    unsigned long mutations = _buffer.mutations;
+    SQChunkedBuffer *buffer = &_buffer;
+    SQTestResults results = SQTestResultsTake(&_testResults, count);
+    uint8_t *marks = results.bytes;
+    SQEvaluateTest(marks, count, opts, &_buffer.mutations, ^id(NSUInteger index) {
+        
+        return SQChunkedBufferObjectAtIndex(buffer, index);
+        
+    }, predicate);
+    
+    if (_buffer.mutations != mutations) {
+        
+        SQTestResultsReturn(&_testResults, results);
+        [NSException raise:NSGenericException format:@"*** Queue <%p> was mutated while its objects were being tested", self];
+        
+    }
+    
+    os_unfair_lock_lock(&_bufferLock);
+    NSUInteger removed = SQChunkedBufferRemoveMarkedObjects(&_buffer, marks);
+    os_unfair_lock_unlock(&_bufferLock);
+    
+    if (removed > 0 && _changeObservers.count > 0) {
+        
+        SQEnumerateRemovedRanges(marks, count, ^(NSRange range) {
+            
+            [self recordRemovalOfRange:range];
+            
+        });
+        
+    }
+    
+    SQTestResultsReturn(&_testResults, results);
+    
+    return removed;
+    
+}
+
+- (void)filterUsingPredicate:(NSPredicate *)predicate {
+    
+    [self removeObjectsPassingTest:^BOOL(id obj, NSUInteger idx, BOOL *stop) {
+        
+        return ![predicate evaluateWithObject:obj];
+        
+    }];
+    
+}
+
 #pragma mark - Get Objects
 
 - (id)objectAtIndex:(NSUInteger)index {
     
-    return self.internalArray[index];
+    if (index >= _buffer.count) {
+        
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds for queue of count %lu", (unsigned long)index, (unsigned long)_buffer.count];
+        
+    }
+    
+    return SQChunkedBufferObjectAtIndex(&_buffer, index);
     
 }
 
@@ -562,50 +994,48 @@
     if (idx1 == idx2)
         return;
     
-    NSUInteger firstIndex = MIN(idx1, idx2);
-    NSUInteger secondIndex = MAX(idx1, idx2);
-    
-    NSArray *firstSub = [self.internalArray subarrayWithRange:NSMakeRange(0, firstIndex)];
-    id first = self.internalArray[firstIndex];
-    NSUInteger secondLen = secondIndex - firstIndex - 1;
-    NSArray *secondSub = [self.internalArray subarrayWithRange:NSMakeRange(firstIndex + 1, secondLen == -1 ? 0 : secondLen)];
-    id second = self.internalArray[secondIndex];
-    NSUInteger finalLen = self.internalArray.count - secondIndex - 1;
-    NSArray *finalSub = [self.internalArray subarrayWithRange:NSMakeRange(secondIndex + 1, finalLen)];
+    NSMutableArray *objects = [self.internalArray mutableCopy];
+    [objects exchangeObjectAtIndex:idx1 withObjectAtIndex:idx2];
     
-    _internalArray = [[[[firstSub arrayByAddingObject:second] arrayByAddingObjectsFromArray:secondSub] arrayByAddingObject:first] arrayByAddingObjectsFromArray:finalSub];
+    [self replaceContentsWithArray:objects];
+    [self recordReorder];
     
 }
 
 - (void)sortUsingDescriptors:(NSArray<NSSortDescriptor *> *)sortDescriptors {
     
-    _internalArray = [self.internalArray sortedArrayUsingDescriptors:sortDescriptors];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayUsingDescriptors:sortDescriptors]];
+    [self recordReorder];
     
 }
 
 - (void)sortUsingComparator:(NSComparator)cmptr {
     
-    _internalArray = [self.internalArray sortedArrayUsingComparator:cmptr];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayUsingComparator:cmptr]];
+    [self recordReorder];
     
 }
 
 - (void)sortWithOptions:(NSSortOptions)opts usingComparator:(NSComparator)cmptr {
     
-    _internalArray = [self.internalArray sortedArrayWithOptions:opts
-                                                usingComparator:cmptr];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayWithOptions:opts
+                                                              usingComparator:cmptr]];
+    [self recordReorder];
     
 }
 
 - (void)sortUsingFunction:(NSInteger (*)(id  _Nonnull __strong, id  _Nonnull __strong, void * _Nonnull))compare context:(void *)context {
     
-    _internalArray = [self.internalArray sortedArrayUsingFunction:compare
-                                                          context:context];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayUsingFunction:compare
+                                                                        context:context]];
+    [self recordReorder];
     
 }
 
 - (void)sortUsingSelector:(SEL)aSelector {
     
-    _internalArray = [self.internalArray sortedArrayUsingSelector:aSelector];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayUsingSelector:aSelector]];
+    [self recordReorder];
     
 }
 
@@ -617,6 +1047,105 @@
     
 }
 
+#pragma mark - Binary Coding
+
+- (BOOL)writeToStream:(NSOutputStream *)stream error:(NSError **)error {
+    
+    SQBinaryEncoder *encoder = [[SQBinaryEncoder alloc] initWithStream:stream];
+    
+    // Write a snapshot, so the queue can keep changing while it's written out
+    for (id object in [self snapshot]) {
+        
+        if (![encoder encodeObject:object error:error])
+            return NO;
+        
+    }
+    
+    return [encoder finishWithError:error];
+    
+}
+
+- (BOOL)enqueueObjectsFromStream:(NSInputStream *)stream allowedClasses:(NSSet<Class> *)allowedClasses error:(NSError **)error {
+    
+    SQBinaryDecoder *decoder = [[SQBinaryDecoder alloc] initWithStream:stream allowedClasses:allowedClasses];
+    
+    return [decoder decodeObjectsUsingBlock:^(NSArray *batch) {
+        
+        [self enqueueObjects:batch];
+        
+    } error:error];
+    
+}
+
+#pragma mark - Key-Value Coding
+
+- (void)int64ValuesForKey:(NSString *)key into:(int64_t *)buffer {
+    
+    SQInt64ValuesForKey(self, key, buffer);
+    
+}
+
+- (void)doubleValuesForKey:(NSString *)key into:(double *)buffer {
+    
+    SQDoubleValuesForKey(self, key, buffer);
+    
+}
+
+#pragma mark - Observing Changes
+
+- (id<NSObject>)addChangeObserverOnQueue:(dispatch_queue_t)queue usingBlock:(void (^)(NSArray<StackQueueChange *> * _Nonnull))block {
+    
+    SQChangeObserver *observer = [[SQChangeObserver alloc] initWithQueue:queue
+                                                             removalEdge:SQChangeObserverRemovalEdgeFront
+                                                                   block:block];
+    
+    if (!_changeObservers) {
+        
+        _changeObservers = [NSMutableArray array];
+        
+    }
+    
+    [_changeObservers addObject:observer];
+    
+    os_unfair_lock_lock(&_bufferLock);
+    [self updateFastPaths];
+    os_unfair_lock_unlock(&_bufferLock);
+    
+    return observer;
+    
+}
+
+- (void)removeChangeObserver:(id<NSObject>)observer {
+    
+    [(SQChangeObserver *)observer invalidate];
+    [_changeObservers removeObjectIdenticalTo:observer];
+    
+    if (_changeObservers.count == 0) {
+        
+        _changeObservers = nil;
+        
+    }
+    
+    os_unfair_lock_lock(&_bufferLock);
+    [self updateFastPaths];
+    os_unfair_lock_unlock(&_bufferLock);
+    
+}
+
+#pragma mark - Snapshots
+
+- (QueueSnapshot *)snapshot {
+    
+    SQChunkedBuffer shared;
+    
+    os_unfair_lock_lock(&_bufferLock);
+    SQChunkedBufferInitWithBuffer(&shared, &_buffer);
+    os_unfair_lock_unlock(&_bufferLock);
+    
+    return [[QueueSnapshot alloc] initWithBuffer:shared];
+    
+}
+
 #pragma mark - Contents Observation
 
 - (void)addObserver:(NSObject *)observer toObjectsAtIndexes:(NSIndexSet *)indexes forKeyPath:(NSString *)keyPath options:(NSKeyValueObservingOptions)options context:(void *)context {
@@ -647,7 +1176,13 @@
         
     }
     
-    return [self.internalArray isEqualToArray:self.internalArray];
+    if (queue.count != self.count) {
+        
+        return NO;
+        
+    }
+    
+    return [self.internalArray isEqualToArray:queue.internalArray];
     
 }
 
@@ -657,4 +1192,162 @@
     
 }
 
+#pragma mark - Private Instance Methods
+
+- (instancetype)initWithFirstObject:(id)firstObj arguments:(va_list)args {
+    
+    self = [self initWithArray:@[]];
+    
+    if (self) {
+        
+        for (id arg = firstObj; arg != nil; arg = va_arg(args, id)) {
+            
+            SQChunkedBufferAppend(&_buffer, arg);
+            
+        }
+        
+    }
+    
+    return self;
+    
+}
+
+- (void)replaceContentsWithArray:(NSArray *)array {
+    
+    os_unfair_lock_lock(&_bufferLock);
+    SQChunkedBufferDestroy(&_buffer);
+    SQChunkedBufferAppendArray(&_buffer, array);
+    os_unfair_lock_unlock(&_bufferLock);
+    
+}
+
+/**
+ Recompute which operations the inline functions may perform directly. Call with the buffer lock held. Enqueue and dequeue must go through their methods while there are change observers to notify, and enqueue must while there are waiting requests to hand objects to.
+ */
+- (void)updateFastPaths {
+    
+    uint32_t fastPaths = _inheritedFastPaths;
+    
+    if (_changeObservers.count > 0) {
+        
+        fastPaths &= ~(uint32_t)(SQQueueFastPathEnqueue | SQQueueFastPathDequeue);
+        
+    }
+    
+    if (_firstRequest) {
+        
+        fastPaths &= ~(uint32_t)SQQueueFastPathEnqueue;
+        
+    }
+    
+    _fastPaths = fastPaths;
+    
+}
+
+- (void)appendRequest:(SQDequeueRequest *)request {
+    
+    request.pending = YES;
+    request.previous = _lastRequest;
+    
+    if (_lastRequest) {
+        
+        _lastRequest.next = request;
+        
+    } else {
+        
+        _firstRequest = request;
+        
+    }
+    
+    _lastRequest = request;
+    [self updateFastPaths];
+    
+}
+
+- (void)unlinkRequest:(SQDequeueRequest *)request {
+    
+    SQDequeueRequest *next = request.next;
+    SQDequeueRequest *previous = request.previous;
+    
+    if (previous) {
+        
+        previous.next = next;
+        
+    } else {
+        
+        _firstRequest = next;
+        
+    }
+    
+    if (next) {
+        
+        next.previous = previous;
+        
+    } else {
+        
+        _lastRequest = previous;
+        
+    }
+    
+    request.next = nil;
+    request.previous = nil;
+    request.pending = NO;
+    [self updateFastPaths];
+    
+}
+
+- (SQDequeueRequest *)removeFirstRequest {
+    
+    SQDequeueRequest *request = _firstRequest;
+    
+    if (request) {
+        
+        [self unlinkRequest:request];
+        
+    }
+    
+    return request;
+    
+}
+
+- (void)recordInsertionOfCount:(NSUInteger)count previousCount:(NSUInteger)previousCount {
+    
+    for (SQChangeObserver *observer in _changeObservers) {
+        
+        [observer recordInsertionOfCount:count previousCount:previousCount];
+        
+    }
+    
+}
+
+- (void)recordRemovalOfCount:(NSUInteger)count previousCount:(NSUInteger)previousCount {
+    
+    for (SQChangeObserver *observer in _changeObservers) {
+        
+        [observer recordRemovalOfCount:count previousCount:previousCount];
+        
+    }
+    
+}
+
+- (void)recordRemovalOfRange:(NSRange)range {
+    
+    for (SQChangeObserver *observer in _changeObservers) {
+        
+        [observer recordRemovalOfRange:range];
+        
+    }
+    
+}
+
+- (void)recordReorder {
+    
+    for (SQChangeObserver *observer in _changeObservers) {
+        
+        [observer recordReorderOfCount:self.count];
+        
+    }
+    
+}
+
 @end
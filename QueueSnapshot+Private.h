@@ -0,0 +1,26 @@
+//
+//  QueueSnapshot+Private.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "QueueSnapshot.h"
+#import "SQChunkedBuffer.h"
+
+@interface QueueSnapshot ()
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Create a snapshot that takes ownership of a shared buffer
+
+ @param buffer The buffer, which must already share its contents with the queue
+ @return The snapshot
+ */
+- (instancetype)initWithBuffer:(SQChunkedBuffer)buffer NS_DESIGNATED_INITIALIZER;
+
+NS_ASSUME_NONNULL_END
+
+@end
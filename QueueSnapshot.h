@@ -0,0 +1,81 @@
+//
+//  QueueSnapshot.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+/**
+ An immutable, point-in-time view of a Queue
+ 
+ @discussion Snapshots are created in O(1) with -[Queue snapshot], and share storage with the queue copy-on-write. The queue can keep enqueueing and dequeueing while a snapshot is alive, and only pays to copy the storage it actually touches. Snapshots are safe to read from any thread.
+ */
+@interface QueueSnapshot<__covariant ObjectType> : NSObject<NSCopying, NSFastEnumeration>
+
+NS_ASSUME_NONNULL_BEGIN
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ The number of items in the snapshot
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+/**
+ View the item that was at the front of the queue
+ 
+ @return The item at the front of the snapshot
+ */
+- (nullable ObjectType)peek;
+
+/**
+ Get the object in the snapshot at the given index
+ 
+ @param index The index
+ @return The item at the index
+ */
+- (ObjectType)objectAtIndex:(NSUInteger)index;
+
+/**
+ Get the object at the given index of the snapshot, via subscript.
+ 
+ @param idx The index
+ @return The item at the index
+ */
+- (ObjectType)objectAtIndexedSubscript:(NSUInteger)idx;
+
+/**
+ Check if the snapshot contains an object
+ 
+ @param object The object to search for in the snapshot
+ @return YES if the snapshot contains the object, otherwise NO.
+ */
+- (BOOL)containsObject:(ObjectType)object;
+
+/**
+ Enumerate over the contents of the snapshot with a block
+ 
+ @param block The block to execute over each object in the snapshot
+ */
+- (void)enumerateObjectsUsingBlock:(void (^)(ObjectType obj, NSUInteger idx, BOOL *stop))block;
+
+/**
+ Create an NSEnumerator to enumerate over the snapshot
+ 
+ @return The NSEnumerator
+ */
+- (NSEnumerator<ObjectType> *)objectEnumerator;
+
+/**
+ The contents of the snapshot, as an NSArray
+ 
+ @note This copies the snapshot, and is O(n)
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSArray<ObjectType> *allObjects;
+
+NS_ASSUME_NONNULL_END
+
+@end
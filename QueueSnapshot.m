@@ -0,0 +1,176 @@
+//
+//  QueueSnapshot.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "QueueSnapshot+Private.h"
+
+@interface QueueSnapshotEnumerator : NSEnumerator {
+    
+    QueueSnapshot *_snapshotToEnumerate;
+    NSUInteger _currentIndex;
+    
+}
+
+- (instancetype)initWithSnapshot:(QueueSnapshot *)snapshot;
+
+@end
+
+@implementation QueueSnapshotEnumerator
+
+- (instancetype)initWithSnapshot:(QueueSnapshot *)snapshot {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _snapshotToEnumerate = snapshot;
+        
+    }
+    
+    return self;
+    
+}
+
+- (id)nextObject {
+    
+    if (_currentIndex >= _snapshotToEnumerate.count)
+        return nil;
+    
+    return _snapshotToEnumerate[_currentIndex++];
+    
+}
+
+@end
+
+@implementation QueueSnapshot {
+    
+    SQChunkedBuffer _buffer;
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (void)dealloc {
+    
+    SQChunkedBufferDestroy(&_buffer);
+    
+}
+
+- (NSString *)description {
+    
+    return self.allObjects.description;
+    
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    
+    return self;
+    
+}
+
+#pragma mark - NSFastEnumeration
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id  _Nullable __unsafe_unretained [])buffer count:(NSUInteger)len {
+    
+    return SQChunkedBufferEnumerate(&_buffer, state);
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithBuffer:(SQChunkedBuffer)buffer {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _buffer = buffer;
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (NSUInteger)count {
+    
+    return _buffer.count;
+    
+}
+
+- (NSArray *)allObjects {
+    
+    return SQChunkedBufferCopyArray(&_buffer);
+    
+}
+
+#pragma mark - Public Instance Methods
+
+- (id)peek {
+    
+    return _buffer.count > 0 ? SQChunkedBufferObjectAtIndex(&_buffer, 0) : nil;
+    
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    
+    if (index >= _buffer.count) {
+        
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds for snapshot of count %lu", (unsigned long)index, (unsigned long)_buffer.count];
+        
+    }
+    
+    return SQChunkedBufferObjectAtIndex(&_buffer, index);
+    
+}
+
+- (id)objectAtIndexedSubscript:(NSUInteger)idx {
+    
+    return [self objectAtIndex:idx];
+    
+}
+
+- (BOOL)containsObject:(id)object {
+    
+    for (id candidate in self) {
+        
+        if ([candidate isEqual:object])
+            return YES;
+        
+    }
+    
+    return NO;
+    
+}
+
+- (void)enumerateObjectsUsingBlock:(void (^)(id _Nonnull, NSUInteger, BOOL * _Nonnull))block {
+    
+    NSUInteger idx = 0;
+    BOOL stop = NO;
+    
+    for (id object in self) {
+        
+        block(object, idx++, &stop);
+        
+        if (stop)
+            break;
+        
+    }
+    
+}
+
+- (NSEnumerator *)objectEnumerator {
+    
+    return [[QueueSnapshotEnumerator alloc] initWithSnapshot:self];
+    
+}
+
+@end
@@ -0,0 +1,63 @@
+//
+//  Queueing.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The FIFO operations shared by the queue classes, so code can be written against any of them
+
+ @discussion Each conforming class documents its own thread safety and ordering. For a ShardedQueue, FIFO order only holds within a lane.
+ */
+@protocol Queueing <NSObject>
+
+/**
+ @name Enqueue, Peek, Dequeue
+ */
+
+/**
+ Enqueue an object
+
+ @param object The object
+ */
+- (void)enqueue:(id)object;
+
+/**
+ Enqueue an array of objects, in order
+
+ @param objects The array
+ */
+- (void)enqueueObjects:(NSArray *)objects;
+
+/**
+ View the item that -dequeue would return next, without removing it
+
+ @return The item, or nil if the queue is empty
+ */
+- (nullable id)peek;
+
+/**
+ Dequeue an item
+
+ @return The item, or nil if the queue is empty
+ */
+- (nullable id)dequeue;
+
+/**
+ @name Content Checking
+ */
+
+/**
+ The number of items in the queue
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,108 @@
+//
+//  SQBinaryCodec.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The error domain for errors reading or writing the binary format
+ */
+FOUNDATION_EXTERN NSErrorDomain const SQBinaryCodecErrorDomain;
+
+/**
+ Errors reading or writing the binary format
+ */
+typedef NS_ERROR_ENUM(SQBinaryCodecErrorDomain, SQBinaryCodecError) {
+
+    /**
+     The stream failed. The stream's own error is under NSUnderlyingErrorKey.
+     */
+    SQBinaryCodecErrorStream = 1,
+
+    /**
+     The stream ended in the middle of a record, or before the end marker
+     */
+    SQBinaryCodecErrorTruncated,
+
+    /**
+     The data isn't in the binary format, or a record couldn't be decoded
+     */
+    SQBinaryCodecErrorCorrupt,
+
+    /**
+     An object couldn't be encoded, because it isn't a string, number or data object and doesn't support secure coding
+     */
+    SQBinaryCodecErrorUnsupportedObject
+
+};
+
+/**
+ Writes objects to a stream in a compact, length-prefixed binary format.
+
+ @discussion The format is a 4 byte magic number, followed by one record per object, followed by an end marker. Each record is a one byte tag, a varint payload length and the payload. Strings are stored as UTF-8, integers and doubles as 8 little-endian bytes, and data objects as is. Anything else is archived with NSKeyedArchiver, with secure coding required. Writes are buffered, so nothing is held in memory beyond the buffer and the current object. Objects whose payload is over 64 MB, and strings that have no UTF-8 form, can't be encoded.
+ */
+@interface SQBinaryEncoder : NSObject
+
+/**
+ Create an encoder, and write the magic number
+
+ @param stream The stream to write to. The stream is opened if it isn't already, and left open.
+ @return The encoder
+ */
+- (instancetype)initWithStream:(NSOutputStream *)stream NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Write an object
+
+ @param object The object
+ @param error The error, if the object couldn't be written
+ @return YES if the object was written, otherwise NO.
+ */
+- (BOOL)encodeObject:(id)object error:(NSError **)error;
+
+/**
+ Write the end marker, and flush everything that's buffered
+
+ @param error The error, if the stream failed
+ @return YES if everything was written, otherwise NO.
+ */
+- (BOOL)finishWithError:(NSError **)error;
+
+@end
+
+/**
+ Reads objects written by SQBinaryEncoder from a stream, incrementally, with a fixed-size read buffer. A record claiming a payload over 64 MB is treated as corrupt, so a bad length can't make the decoder buffer more than that.
+ */
+@interface SQBinaryDecoder : NSObject
+
+/**
+ Create a decoder
+
+ @param stream The stream to read from. The stream is opened if it isn't already, and left open.
+ @param allowedClasses The classes that archived objects may decode as, for objects that aren't strings, numbers or data objects
+ @return The decoder
+ */
+- (instancetype)initWithStream:(NSInputStream *)stream allowedClasses:(NSSet<Class> *)allowedClasses NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Read every object up to the end marker, handing them to a block in order, in batches, as they're read
+
+ @param block The block. Each batch holds at most a few thousand objects, and isn't retained by the decoder once the block returns.
+ @param error The error, if the stream failed or didn't hold valid data
+ @return YES if the end marker was reached, otherwise NO. Batches already handed to the block stay handed over.
+ */
+- (BOOL)decodeObjectsUsingBlock:(void (NS_NOESCAPE ^)(NSArray *batch))block error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,646 @@
+//
+//  SQBinaryCodec.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "SQBinaryCodec.h"
+
+#import <libkern/OSByteOrder.h>
+
+NSErrorDomain const SQBinaryCodecErrorDomain = @"SQBinaryCodecErrorDomain";
+
+static const uint8_t SQBinaryCodecMagic[4] = { 'S', 'Q', 'B', '1' };
+
+#define SQBinaryCodecBufferSize 65536
+#define SQBinaryCodecBatchSize 4096
+
+/**
+ The longest record either side will handle, so a corrupt length can't make the decoder buffer gigabytes
+ */
+#define SQBinaryCodecMaximumRecordLength (64 * 1024 * 1024)
+
+typedef NS_ENUM(uint8_t, SQBinaryCodecTag) {
+    
+    SQBinaryCodecTagEnd = 0,
+    SQBinaryCodecTagString = 1,
+    SQBinaryCodecTagInteger = 2,
+    SQBinaryCodecTagDouble = 3,
+    SQBinaryCodecTagData = 4,
+    SQBinaryCodecTagBoolean = 5,
+    SQBinaryCodecTagArchive = 6
+    
+};
+
+static NSError *SQBinaryCodecMakeError(SQBinaryCodecError code, NSString *description, NSError *underlyingError) {
+    
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:description forKey:NSLocalizedDescriptionKey];
+    
+    if (underlyingError) {
+        
+        userInfo[NSUnderlyingErrorKey] = underlyingError;
+        
+    }
+    
+    return [NSError errorWithDomain:SQBinaryCodecErrorDomain code:code userInfo:userInfo];
+    
+}
+
+#pragma mark - Encoder
+
+@implementation SQBinaryEncoder {
+    
+    NSOutputStream *_stream;
+    uint8_t *_bytes;
+    NSUInteger _used;
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithStream:(NSOutputStream *)stream {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _stream = stream;
+        _bytes = malloc(SQBinaryCodecBufferSize);
+        
+        if (stream.streamStatus == NSStreamStatusNotOpen) {
+            
+            [stream open];
+            
+        }
+        
+        memcpy(_bytes, SQBinaryCodecMagic, sizeof(SQBinaryCodecMagic));
+        _used = sizeof(SQBinaryCodecMagic);
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (void)dealloc {
+    
+    free(_bytes);
+    
+}
+
+#pragma mark - Public Instance Methods
+
+- (BOOL)encodeObject:(id)object error:(NSError **)error {
+    
+    if ([object isKindOfClass:[NSString class]]) {
+        
+        return [self encodeString:object error:error];
+        
+    } else if ([object isKindOfClass:[NSNumber class]] && ![object isKindOfClass:[NSDecimalNumber class]]) {
+        
+        NSNumber *number = object;
+        
+        if ((__bridge CFBooleanRef)number == kCFBooleanTrue || (__bridge CFBooleanRef)number == kCFBooleanFalse) {
+            
+            uint8_t value = number.boolValue;
+            
+            return [self encodeTag:SQBinaryCodecTagBoolean bytes:&value length:1 error:error];
+            
+        } else if (CFNumberIsFloatType((__bridge CFNumberRef)number)) {
+            
+            double value = number.doubleValue;
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            bits = OSSwapHostToLittleInt64(bits);
+            
+            return [self encodeTag:SQBinaryCodecTagDouble bytes:&bits length:sizeof(bits) error:error];
+            
+        } else if (strcmp(number.objCType, @encode(unsigned long long)) != 0 || number.unsignedLongLongValue <= INT64_MAX) {
+            
+            uint64_t bits = OSSwapHostToLittleInt64((uint64_t)number.longLongValue);
+            
+            return [self encodeTag:SQBinaryCodecTagInteger bytes:&bits length:sizeof(bits) error:error];
+            
+        }
+        
+        // Unsigned values that don't fit in an int64 fall through to the archive
+        
+    } else if ([object isKindOfClass:[NSData class]]) {
+        
+        NSData *data = object;
+        
+        return [self encodeTag:SQBinaryCodecTagData bytes:data.bytes length:data.length error:error];
+        
+    }
+    
+    NSError *archiveError;
+    NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:object requiringSecureCoding:YES error:&archiveError];
+    
+    if (!archive) {
+        
+        if (error) {
+            
+            *error = SQBinaryCodecMakeError(SQBinaryCodecErrorUnsupportedObject, [NSString stringWithFormat:@"%@ can't be encoded", NSStringFromClass([object class])], archiveError);
+            
+        }
+        
+        return NO;
+        
+    }
+    
+    return [self encodeTag:SQBinaryCodecTagArchive bytes:archive.bytes length:archive.length error:error];
+    
+}
+
+- (BOOL)finishWithError:(NSError **)error {
+    
+    uint8_t end = SQBinaryCodecTagEnd;
+    
+    return [self writeBytes:&end length:1 error:error] && [self flushWithError:error];
+    
+}
+
+#pragma mark - Private Instance Methods
+
+- (BOOL)encodeString:(NSString *)string error:(NSError **)error {
+    
+    // Strings with unpaired surrogates have no UTF-8 form, and report a length of 0
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    
+    if (length == 0 && string.length > 0) {
+        
+        if (error) {
+            
+            *error = SQBinaryCodecMakeError(SQBinaryCodecErrorUnsupportedObject, @"A string couldn't be converted to UTF-8", nil);
+            
+        }
+        
+        return NO;
+        
+    }
+    
+    if (![self writeHeaderWithTag:SQBinaryCodecTagString length:length error:error])
+        return NO;
+    
+    // Transcode straight into the write buffer, flushing whenever it fills up
+    NSRange remaining = NSMakeRange(0, string.length);
+    
+    while (remaining.length > 0) {
+        
+        if (SQBinaryCodecBufferSize - _used < 4 && ![self flushWithError:error])
+            return NO;
+        
+        NSUInteger used = 0;
+        NSUInteger before = remaining.length;
+        [string getBytes:_bytes + _used
+               maxLength:SQBinaryCodecBufferSize - _used
+              usedLength:&used
+                encoding:NSUTF8StringEncoding
+                 options:0
+                   range:remaining
+          remainingRange:&remaining];
+        _used += used;
+        
+        // No progress with room to spare means a character that can't be converted
+        if (remaining.length == before) {
+            
+            if (error) {
+                
+                *error = SQBinaryCodecMakeError(SQBinaryCodecErrorUnsupportedObject, @"A string couldn't be converted to UTF-8", nil);
+                
+            }
+            
+            return NO;
+            
+        }
+        
+    }
+    
+    return YES;
+    
+}
+
+- (BOOL)encodeTag:(SQBinaryCodecTag)tag bytes:(const void *)bytes length:(NSUInteger)length error:(NSError **)error {
+    
+    return [self writeHeaderWithTag:tag length:length error:error] && [self writeBytes:bytes length:length error:error];
+    
+}
+
+- (BOOL)writeHeaderWithTag:(SQBinaryCodecTag)tag length:(NSUInteger)length error:(NSError **)error {
+    
+    if (length > SQBinaryCodecMaximumRecordLength) {
+        
+        if (error) {
+            
+            *error = SQBinaryCodecMakeError(SQBinaryCodecErrorUnsupportedObject, @"An object is too large to encode", nil);
+            
+        }
+        
+        return NO;
+        
+    }
+    
+    uint8_t header[11];
+    NSUInteger size = 0;
+    header[size++] = tag;
+    
+    do {
+        
+        uint8_t byte = length & 0x7F;
+        length >>= 7;
+        header[size++] = byte | (length ? 0x80 : 0);
+        
+    } while (length);
+    
+    return [self writeBytes:header length:size error:error];
+    
+}
+
+- (BOOL)writeBytes:(const void *)bytes length:(NSUInteger)length error:(NSError **)error {
+    
+    if (length <= SQBinaryCodecBufferSize - _used) {
+        
+        memcpy(_bytes + _used, bytes, length);
+        _used += length;
+        
+        return YES;
+        
+    }
+    
+    if (![self flushWithError:error])
+        return NO;
+    
+    if (length <= SQBinaryCodecBufferSize) {
+        
+        memcpy(_bytes, bytes, length);
+        _used = length;
+        
+        return YES;
+        
+    }
+    
+    // Too big to be worth buffering, so write it straight through
+    return [self writeToStream:bytes length:length error:error];
+    
+}
+
+- (BOOL)flushWithError:(NSError **)error {
+    
+    BOOL written = [self writeToStream:_bytes length:_used error:error];
+    _used = 0;
+    
+    return written;
+    
+}
+
+- (BOOL)writeToStream:(const uint8_t *)bytes length:(NSUInteger)length error:(NSError **)error {
+    
+    while (length > 0) {
+        
+        NSInteger written = [_stream write:bytes maxLength:length];
+        
+        if (written <= 0) {
+            
+            if (error) {
+                
+                *error = SQBinaryCodecMakeError(SQBinaryCodecErrorStream, @"The output stream failed", _stream.streamError);
+                
+            }
+            
+            return NO;
+            
+        }
+        
+        bytes += written;
+        length -= (NSUInteger)written;
+        
+    }
+    
+    return YES;
+    
+}
+
+@end
+
+#pragma mark - Decoder
+
+@implementation SQBinaryDecoder {
+    
+    NSInputStream *_stream;
+    NSSet<Class> *_allowedClasses;
+    uint8_t *_bytes;
+    NSUInteger _capacity;
+    NSUInteger _start;
+    NSUInteger _end;
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithStream:(NSInputStream *)stream allowedClasses:(NSSet<Class> *)allowedClasses {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _stream = stream;
+        _allowedClasses = [allowedClasses copy];
+        _capacity = SQBinaryCodecBufferSize;
+        _bytes = malloc(_capacity);
+        
+        if (stream.streamStatus == NSStreamStatusNotOpen) {
+            
+            [stream open];
+            
+        }
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (void)dealloc {
+    
+    free(_bytes);
+    
+}
+
+#pragma mark - Public Instance Methods
+
+- (BOOL)decodeObjectsUsingBlock:(void (NS_NOESCAPE ^)(NSArray * _Nonnull))block error:(NSError **)error {
+    
+    if (![self ensureLength:sizeof(SQBinaryCodecMagic) error:error])
+        return NO;
+    
+    if (memcmp(_bytes + _start, SQBinaryCodecMagic, sizeof(SQBinaryCodecMagic)) != 0) {
+        
+        if (error) {
+            
+            *error = SQBinaryCodecMakeError(SQBinaryCodecErrorCorrupt, @"The stream isn't in the binary format", nil);
+            
+        }
+        
+        return NO;
+        
+    }
+    
+    _start += sizeof(SQBinaryCodecMagic);
+    
+    NSMutableArray *batch = [NSMutableArray arrayWithCapacity:SQBinaryCodecBatchSize];
+    
+    // Errors are held strongly here, so they outlive the autorelease pool they're created in
+    NSError *decodeError;
+    
+    while (YES) {
+        
+        @autoreleasepool {
+            
+            if (![self ensureLength:1 error:&decodeError])
+                break;
+            
+            SQBinaryCodecTag tag = _bytes[_start++];
+            
+            if (tag == SQBinaryCodecTagEnd) {
+                
+                if (batch.count > 0) {
+                    
+                    block(batch);
+                    
+                }
+                
+                return YES;
+                
+            }
+            
+            NSUInteger length;
+            
+            if (![self readVarint:&length error:&decodeError])
+                break;
+            
+            if (length > SQBinaryCodecMaximumRecordLength) {
+                
+                decodeError = SQBinaryCodecMakeError(SQBinaryCodecErrorCorrupt, @"A record length is too long", nil);
+                break;
+                
+            }
+            
+            if (![self ensureLength:length error:&decodeError])
+                break;
+            
+            id object = [self objectWithTag:tag bytes:_bytes + _start length:length error:&decodeError];
+            
+            if (!object)
+                break;
+            
+            _start += length;
+            [batch addObject:object];
+            
+            if (batch.count == SQBinaryCodecBatchSize) {
+                
+                block(batch);
+                batch = [NSMutableArray arrayWithCapacity:SQBinaryCodecBatchSize];
+                
+            }
+            
+        }
+        
+    }
+    
+    // Hand over what we did manage to read before the failure
+    if (batch.count > 0) {
+        
+        block(batch);
+        
+    }
+    
+    if (error) {
+        
+        *error = decodeError;
+        
+    }
+    
+    return NO;
+    
+}
+
+#pragma mark - Private Instance Methods
+
+- (id)objectWithTag:(SQBinaryCodecTag)tag bytes:(const uint8_t *)bytes length:(NSUInteger)length error:(NSError **)error {
+    
+    id object = nil;
+    NSError *underlyingError = nil;
+    uint64_t bits;
+    
+    switch (tag) {
+        
+        case SQBinaryCodecTagString:
+            object = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+            break;
+        
+        case SQBinaryCodecTagInteger:
+            if (length == sizeof(bits)) {
+                
+                memcpy(&bits, bytes, sizeof(bits));
+                object = @((int64_t)OSSwapLittleToHostInt64(bits));
+                
+            }
+            break;
+        
+        case SQBinaryCodecTagDouble:
+            if (length == sizeof(bits)) {
+                
+                memcpy(&bits, bytes, sizeof(bits));
+                bits = OSSwapLittleToHostInt64(bits);
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                object = @(value);
+                
+            }
+            break;
+        
+        case SQBinaryCodecTagBoolean:
+            if (length == 1) {
+                
+                object = bytes[0] ? @YES : @NO;
+                
+            }
+            break;
+        
+        case SQBinaryCodecTagData:
+            object = [NSData dataWithBytes:bytes length:length];
+            break;
+        
+        case SQBinaryCodecTagArchive:
+            object = [NSKeyedUnarchiver unarchivedObjectOfClasses:_allowedClasses
+                                                         fromData:[NSData dataWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO]
+                                                            error:&underlyingError];
+            break;
+        
+        default:
+            break;
+        
+    }
+    
+    if (!object && error) {
+        
+        *error = SQBinaryCodecMakeError(SQBinaryCodecErrorCorrupt, [NSString stringWithFormat:@"A record with tag %u couldn't be decoded", tag], underlyingError);
+        
+    }
+    
+    return object;
+    
+}
+
+- (BOOL)readVarint:(NSUInteger *)value error:(NSError **)error {
+    
+    NSUInteger result = 0;
+    
+    for (NSUInteger shift = 0; shift < 64; shift += 7) {
+        
+        if (![self ensureLength:1 error:error])
+            return NO;
+        
+        uint8_t byte = _bytes[_start++];
+        result |= (NSUInteger)(byte & 0x7F) << shift;
+        
+        if (!(byte & 0x80)) {
+            
+            *value = result;
+            return YES;
+            
+        }
+        
+    }
+    
+    if (error) {
+        
+        *error = SQBinaryCodecMakeError(SQBinaryCodecErrorCorrupt, @"A record length is too long", nil);
+        
+    }
+    
+    return NO;
+    
+}
+
+/**
+ Make sure a number of bytes are buffered, reading from the stream as needed
+ 
+ @param length The number of bytes, from the current position
+ @param error The error, if the stream failed or ended first
+ @return YES if the bytes are buffered, otherwise NO
+ */
+- (BOOL)ensureLength:(NSUInteger)length error:(NSError **)error {
+    
+    if (_end - _start >= length)
+        return YES;
+    
+    // Slide what's left to the front, and make room for an oversized record only while we need it
+    memmove(_bytes, _bytes + _start, _end - _start);
+    _end -= _start;
+    _start = 0;
+    
+    NSUInteger capacity = MAX(length, SQBinaryCodecBufferSize);
+    
+    if (capacity != _capacity && _end <= capacity) {
+        
+        uint8_t *bytes = realloc(_bytes, capacity);
+        
+        if (!bytes) {
+            
+            if (error) {
+                
+                *error = SQBinaryCodecMakeError(SQBinaryCodecErrorCorrupt, @"A record is too large to buffer", nil);
+                
+            }
+            
+            return NO;
+            
+        }
+        
+        _bytes = bytes;
+        _capacity = capacity;
+        
+    }
+    
+    while (_end < length) {
+        
+        NSInteger read = [_stream read:_bytes + _end maxLength:_capacity - _end];
+        
+        if (read < 0) {
+            
+            if (error) {
+                
+                *error = SQBinaryCodecMakeError(SQBinaryCodecErrorStream, @"The input stream failed", _stream.streamError);
+                
+            }
+            
+            return NO;
+            
+        } else if (read == 0) {
+            
+            if (error) {
+                
+                *error = SQBinaryCodecMakeError(SQBinaryCodecErrorTruncated, @"The input stream ended before the end marker", nil);
+                
+            }
+            
+            return NO;
+            
+        }
+        
+        _end += (NSUInteger)read;
+        
+    }
+    
+    return YES;
+    
+}
+
+@end
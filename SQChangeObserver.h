@@ -0,0 +1,88 @@
+//
+//  SQChangeObserver.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+#import "StackQueueChange.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The end of a container that objects are removed from
+ */
+typedef NS_ENUM(NSUInteger, SQChangeObserverRemovalEdge) {
+
+    /**
+     Objects are removed from the front, as in a queue
+     */
+    SQChangeObserverRemovalEdgeFront,
+
+    /**
+     Objects are removed from the back, as in a stack
+     */
+    SQChangeObserverRemovalEdgeBack
+
+};
+
+/**
+ A subscription to the changes of a single stack or queue.
+
+ @discussion Mutations are recorded on the mutating thread and coalesced until the observer's dispatch queue gets around to delivering them, so any number of insertions and removals between two deliveries collapse into at most one removal and one insertion. Reorders split the batch, since ranges after a reorder can't be folded into the ones before it.
+ */
+@interface SQChangeObserver : NSObject
+
+/**
+ Create an observer
+
+ @param queue The queue to deliver changes on
+ @param edge The end of the container that objects are removed from
+ @param block The block to deliver changes to
+ @return The observer
+ */
+- (instancetype)initWithQueue:(dispatch_queue_t)queue removalEdge:(SQChangeObserverRemovalEdge)edge block:(void (^)(NSArray<StackQueueChange *> *changes))block NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Record objects appended to the back of the container
+
+ @param count The number of objects
+ @param previousCount The number of objects in the container before the insertion
+ */
+- (void)recordInsertionOfCount:(NSUInteger)count previousCount:(NSUInteger)previousCount;
+
+/**
+ Record objects removed from the removal edge of the container
+
+ @param count The number of objects
+ @param previousCount The number of objects in the container before the removal
+ */
+- (void)recordRemovalOfCount:(NSUInteger)count previousCount:(NSUInteger)previousCount;
+
+/**
+ Record objects removed from anywhere in the container, such as by compaction
+
+ @param range The range of the removed objects, after every change recorded before it has been applied
+ */
+- (void)recordRemovalOfRange:(NSRange)range;
+
+/**
+ Record the contents of the container being reordered
+
+ @param count The number of objects in the container
+ */
+- (void)recordReorderOfCount:(NSUInteger)count;
+
+/**
+ Stop delivering changes, including any that are already pending
+ */
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,240 @@
+//
+//  SQChangeObserver.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "SQChangeObserver.h"
+
+#import <os/lock.h>
+
+@implementation SQChangeObserver {
+    
+    dispatch_queue_t _queue;
+    SQChangeObserverRemovalEdge _edge;
+    void (^_block)(NSArray<StackQueueChange *> *changes);
+    
+    os_unfair_lock _lock;
+    NSMutableArray<StackQueueChange *> *_pendingChanges;
+    BOOL _scheduled;
+    BOOL _invalidated;
+    
+    // The current run of insertions and removals, since the last reorder or delivery
+    BOOL _runOpen;
+    NSUInteger _runBaseCount;
+    NSUInteger _runPreservedCount;
+    NSUInteger _runCount;
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue removalEdge:(SQChangeObserverRemovalEdge)edge block:(void (^)(NSArray<StackQueueChange *> *))block {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _queue = queue;
+        _edge = edge;
+        _block = [block copy];
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _pendingChanges = [NSMutableArray array];
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Public Instance Methods
+
+- (void)recordInsertionOfCount:(NSUInteger)count previousCount:(NSUInteger)previousCount {
+    
+    if (count == 0)
+        return;
+    
+    os_unfair_lock_lock(&_lock);
+    
+    [self openRunWithCount:previousCount];
+    _runCount += count;
+    [self scheduleDelivery];
+    
+    os_unfair_lock_unlock(&_lock);
+    
+}
+
+- (void)recordRemovalOfCount:(NSUInteger)count previousCount:(NSUInteger)previousCount {
+    
+    if (count == 0)
+        return;
+    
+    os_unfair_lock_lock(&_lock);
+    
+    [self openRunWithCount:previousCount];
+    _runCount -= MIN(count, _runCount);
+    
+    if (_edge == SQChangeObserverRemovalEdgeFront) {
+        
+        // The oldest objects leave first, and everything that was there when the run began is older than anything inserted since
+        _runPreservedCount -= MIN(count, _runPreservedCount);
+        
+    } else {
+        
+        // The newest objects leave first, so only the low-water mark eats into what was there when the run began
+        _runPreservedCount = MIN(_runPreservedCount, _runCount);
+        
+    }
+    
+    [self scheduleDelivery];
+    
+    os_unfair_lock_unlock(&_lock);
+    
+}
+
+- (void)recordRemovalOfRange:(NSRange)range {
+    
+    if (range.length == 0)
+        return;
+    
+    os_unfair_lock_lock(&_lock);
+    
+    [self closeRun];
+    
+    StackQueueChange *lastChange = _pendingChanges.lastObject;
+    
+    if (lastChange.kind == StackQueueChangeKindRemoval && lastChange.range.location == range.location) {
+        
+        // The objects that closed up behind the last removal went too, so it's still one removal
+        _pendingChanges[_pendingChanges.count - 1] = [StackQueueChange changeWithKind:StackQueueChangeKindRemoval range:NSMakeRange(range.location, lastChange.range.length + range.length)];
+        
+    } else {
+        
+        [_pendingChanges addObject:[StackQueueChange changeWithKind:StackQueueChangeKindRemoval range:range]];
+        
+    }
+    
+    [self scheduleDelivery];
+    
+    os_unfair_lock_unlock(&_lock);
+    
+}
+
+- (void)recordReorderOfCount:(NSUInteger)count {
+    
+    if (count < 2)
+        return;
+    
+    os_unfair_lock_lock(&_lock);
+    
+    [self closeRun];
+    
+    StackQueueChange *lastChange = _pendingChanges.lastObject;
+    
+    if (lastChange.kind == StackQueueChangeKindReorder && NSEqualRanges(lastChange.range, NSMakeRange(0, count))) {
+        
+        // Sorting twice in a row is still one reorder
+        
+    } else {
+        
+        [_pendingChanges addObject:[StackQueueChange changeWithKind:StackQueueChangeKindReorder range:NSMakeRange(0, count)]];
+        
+    }
+    
+    [self scheduleDelivery];
+    
+    os_unfair_lock_unlock(&_lock);
+    
+}
+
+- (void)invalidate {
+    
+    os_unfair_lock_lock(&_lock);
+    
+    _invalidated = YES;
+    _runOpen = NO;
+    [_pendingChanges removeAllObjects];
+    
+    os_unfair_lock_unlock(&_lock);
+    
+}
+
+#pragma mark - Private Instance Methods
+
+- (void)openRunWithCount:(NSUInteger)count {
+    
+    if (_runOpen)
+        return;
+    
+    _runOpen = YES;
+    _runBaseCount = count;
+    _runPreservedCount = count;
+    _runCount = count;
+    
+}
+
+- (void)closeRun {
+    
+    if (!_runOpen)
+        return;
+    
+    _runOpen = NO;
+    
+    // Whatever survived from the start of the run sits at the back of a queue, or the bottom of a stack
+    NSUInteger removedCount = _runBaseCount - _runPreservedCount;
+    NSUInteger insertedCount = _runCount - _runPreservedCount;
+    NSUInteger removalLocation = _edge == SQChangeObserverRemovalEdgeFront ? 0 : _runPreservedCount;
+    
+    if (removedCount > 0) {
+        
+        [_pendingChanges addObject:[StackQueueChange changeWithKind:StackQueueChangeKindRemoval range:NSMakeRange(removalLocation, removedCount)]];
+        
+    }
+    
+    if (insertedCount > 0) {
+        
+        [_pendingChanges addObject:[StackQueueChange changeWithKind:StackQueueChangeKindInsertion range:NSMakeRange(_runPreservedCount, insertedCount)]];
+        
+    }
+    
+}
+
+- (void)scheduleDelivery {
+    
+    if (_scheduled || _invalidated)
+        return;
+    
+    _scheduled = YES;
+    
+    dispatch_async(_queue, ^{
+        
+        [self deliverChanges];
+        
+    });
+    
+}
+
+- (void)deliverChanges {
+    
+    os_unfair_lock_lock(&_lock);
+    
+    [self closeRun];
+    
+    NSArray<StackQueueChange *> *changes = _pendingChanges;
+    _pendingChanges = [NSMutableArray array];
+    _scheduled = NO;
+    BOOL invalidated = _invalidated;
+    
+    os_unfair_lock_unlock(&_lock);
+    
+    if (!invalidated && changes.count > 0) {
+        
+        _block(changes);
+        
+    }
+    
+}
+
+@end
@@ -0,0 +1,253 @@
+//
+//  SQChunkedBuffer.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+#import <stdatomic.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The number of objects in a single chunk. Must be a power of two.
+ */
+#define SQChunkCapacity 128
+
+/**
+ A fixed-size block of retained objects, shared copy-on-write between buffers
+
+ @discussion A chunk usually stores its objects in its own slots, but a chunk created by adopting a caller's C array is a window onto that array instead. Adopted chunks are sealed, so appending to one always copies it first.
+ */
+typedef struct SQChunk {
+
+    /**
+     The number of chunk indexes that reference this chunk
+     */
+    _Atomic(NSUInteger) references;
+
+    /**
+     The number of slots that have been claimed by a writer. Slots are only ever claimed in order, so any buffer can append to a shared chunk as long as it is the one to claim the next slot.
+     */
+    _Atomic(NSUInteger) filled;
+
+    /**
+     The number of slots backed by memory, which is less than SQChunkCapacity only for the last chunk of an adopted C array
+     */
+    NSUInteger length;
+
+    /**
+     The adopted storage the chunk is a window onto, retained once by the chunk, or NULL if the chunk uses its own slots
+     */
+    CFTypeRef _Nullable storage;
+
+    /**
+     The objects, each retained once by the chunk. Slots that have been dequeued by a buffer with exclusive access are NULL.
+     */
+    const void * _Nullable * _Nonnull objects;
+
+    /**
+     The chunk's own slots, which `objects` points to unless the chunk is adopted
+     */
+    const void * _Nullable slots[];
+
+} SQChunk;
+
+/**
+ A reference counted ring of chunk pointers, shared copy-on-write between buffers
+ */
+typedef struct SQChunkIndex {
+
+    /**
+     The number of buffers that reference this index
+     */
+    _Atomic(NSUInteger) references;
+
+    /**
+     The number of chunk pointers the ring has room for. Always a power of two.
+     */
+    NSUInteger capacity;
+
+    /**
+     The chunks, each retained once by the index. Unused slots are NULL. Slots behind a buffer's first chunk may still hold chunks it drained while the index was shared, until they're reused.
+     */
+    SQChunk * _Nullable chunks[];
+
+} SQChunkIndex;
+
+/**
+ A FIFO buffer of objects stored in chunks.
+
+ @discussion Objects live in fixed-size chunks, and the index of chunks is a ring, so appending and removing never move objects and never compact the index. The only work that isn't constant time is doubling the ring, which copies one pointer per chunk, and happens a logarithmic number of times. A chunk is given up the moment its last object is removed: the buffer keeps one spare to reuse at the back, and frees the rest, so memory tracks the number of objects in the buffer rather than its high water mark.
+
+ Buffers share their index and chunks copy-on-write, so sharing a buffer is O(1), and a writer only pays to copy the index, or the single chunk it's appending to, the first time it touches them after they've been shared. Readers of a shared buffer never see writes, because a writer only ever claims slots beyond the end of every other buffer's view, and only ever clears slots that no other buffer can see.
+ */
+typedef struct SQChunkedBuffer {
+
+    /**
+     The chunk index, or NULL if nothing has been appended since the buffer was initialized or destroyed, or everything still fits in the inline storage
+     */
+    SQChunkIndex * _Nullable index;
+
+    /**
+     The ring slot of the first chunk
+     */
+    NSUInteger head;
+
+    /**
+     The position of the first object in the first chunk, or in the inline storage while there is no index
+     */
+    NSUInteger start;
+
+    /**
+     The number of objects in the buffer
+     */
+    NSUInteger count;
+
+    /**
+     An empty chunk kept for the next append that needs one, or NULL
+     */
+    SQChunk * _Nullable spare;
+
+    /**
+     Storage inside the object that embeds the buffer, which holds the objects until they outgrow it, or NULL. Objects are moved into chunks the first time they don't fit.
+     */
+    const void * _Nullable * _Nullable inlineObjects;
+
+    /**
+     The number of objects the inline storage has room for
+     */
+    NSUInteger inlineCapacity;
+
+    /**
+     A counter that changes on every mutation, for NSFastEnumeration
+     */
+    unsigned long mutations;
+
+} SQChunkedBuffer;
+
+/**
+ Initialize an empty buffer
+
+ @param buffer The buffer
+ */
+FOUNDATION_EXTERN void SQChunkedBufferInit(SQChunkedBuffer *buffer);
+
+/**
+ Initialize an empty buffer that stores its first objects in memory the caller provides, and only allocates chunks once they don't fit
+
+ @param buffer The buffer
+ @param storage The inline storage, which must outlive the buffer
+ @param capacity The number of objects the inline storage has room for
+ */
+FOUNDATION_EXTERN void SQChunkedBufferInitWithInlineStorage(SQChunkedBuffer *buffer, const void * _Nullable * _Nonnull storage, NSUInteger capacity);
+
+/**
+ Initialize a buffer that takes over a C array of retained objects, without copying it
+
+ @param buffer The buffer
+ @param objects The C array. The buffer takes over the reference to each object.
+ @param count The number of objects
+ @param freeWhenDone YES if the C array was allocated with malloc and should be freed once the last chunk viewing it is gone, NO if the caller keeps it alive
+ */
+FOUNDATION_EXTERN void SQChunkedBufferInitNoCopy(SQChunkedBuffer *buffer, const void * _Nullable * _Nullable objects, NSUInteger count, BOOL freeWhenDone);
+
+/**
+ Release everything the buffer references, and leave it empty, back on its inline storage if it has any
+
+ @param buffer The buffer
+ */
+FOUNDATION_EXTERN void SQChunkedBufferDestroy(SQChunkedBuffer *buffer);
+
+/**
+ Initialize a buffer that shares its contents with another, in O(1)
+
+ @discussion Inline storage can't be shared, so objects that are still inline are copied instead. There are never more of those than the inline capacity.
+
+ @param buffer The buffer to initialize
+ @param source The buffer to share
+ */
+FOUNDATION_EXTERN void SQChunkedBufferInitWithBuffer(SQChunkedBuffer *buffer, const SQChunkedBuffer *source);
+
+/**
+ Append an object to the back of the buffer
+
+ @param buffer The buffer
+ @param object The object
+ */
+FOUNDATION_EXTERN void SQChunkedBufferAppend(SQChunkedBuffer *buffer, id object);
+
+/**
+ Append every object in a collection to the back of the buffer
+
+ @param buffer The buffer
+ @param objects The collection
+ */
+FOUNDATION_EXTERN void SQChunkedBufferAppendObjects(SQChunkedBuffer *buffer, id<NSFastEnumeration> objects);
+
+/**
+ Append every object in an array to the back of the buffer, copying whole chunks' worth of objects at a time
+
+ @param buffer The buffer
+ @param objects The array
+ */
+FOUNDATION_EXTERN void SQChunkedBufferAppendArray(SQChunkedBuffer *buffer, NSArray *objects);
+
+/**
+ Remove the object at the front of the buffer
+
+ @param buffer The buffer
+ @return The object, or nil if the buffer is empty
+ */
+FOUNDATION_EXTERN id _Nullable SQChunkedBufferRemoveFirst(SQChunkedBuffer *buffer) NS_RETURNS_RETAINED;
+
+/**
+ Get the object at an index, without bounds checking
+
+ @param buffer The buffer
+ @param index The index, which must be less than the buffer's count
+ @return The object
+ */
+NS_INLINE id SQChunkedBufferObjectAtIndex(const SQChunkedBuffer *buffer, NSUInteger index) {
+
+    NSUInteger position = buffer->start + index;
+    SQChunkIndex *chunks = buffer->index;
+
+    if (!chunks)
+        return (__bridge id)buffer->inlineObjects[position];
+
+    return (__bridge id)chunks->chunks[(buffer->head + position / SQChunkCapacity) & (chunks->capacity - 1)]->objects[position % SQChunkCapacity];
+
+}
+
+/**
+ Remove every object marked for removal, closing up the survivors in place in a single pass
+
+ @discussion Compaction writes into the buffer's chunks, so if any of them are shared the survivors are copied into new chunks instead. Marking is left to the caller, so a test can run before taking whatever lock guards the buffer.
+ @param buffer The buffer
+ @param marks One byte per object in the buffer, nonzero for each object to remove
+ @return The number of objects removed
+ */
+FOUNDATION_EXTERN NSUInteger SQChunkedBufferRemoveMarkedObjects(SQChunkedBuffer *buffer, const uint8_t *marks);
+
+/**
+ Implement NSFastEnumeration over a buffer, handing out objects directly from its chunks
+
+ @param buffer The buffer
+ @param state The enumeration state
+ @return The number of objects in the returned batch
+ */
+FOUNDATION_EXTERN NSUInteger SQChunkedBufferEnumerate(SQChunkedBuffer *buffer, NSFastEnumerationState *state);
+
+/**
+ Copy the contents of the buffer into an NSArray
+
+ @param buffer The buffer
+ @return The array
+ */
+FOUNDATION_EXTERN NSArray *SQChunkedBufferCopyArray(const SQChunkedBuffer *buffer);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,824 @@
+//
+//  SQChunkedBuffer.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "SQChunkedBuffer.h"
+
+#pragma mark - Chunks
+
+static SQChunk *SQChunkCreate(void) {
+    
+    SQChunk *chunk = calloc(1, sizeof(SQChunk) + SQChunkCapacity * sizeof(void *));
+    atomic_init(&chunk->references, 1);
+    atomic_init(&chunk->filled, 0);
+    chunk->length = SQChunkCapacity;
+    chunk->objects = chunk->slots;
+    
+    return chunk;
+    
+}
+
+static SQChunk *SQChunkCreateAdopted(CFTypeRef storage, const void **objects, NSUInteger length) {
+    
+    SQChunk *chunk = calloc(1, sizeof(SQChunk));
+    atomic_init(&chunk->references, 1);
+    
+    // Sealed, so nobody ever claims a slot past the end of the adopted memory
+    atomic_init(&chunk->filled, SQChunkCapacity);
+    chunk->length = length;
+    chunk->storage = CFRetain(storage);
+    chunk->objects = objects;
+    
+    return chunk;
+    
+}
+
+/**
+ Release the objects a chunk still holds, leaving its slots NULL
+ 
+ @param chunk The chunk
+ */
+static void SQChunkClear(SQChunk *chunk) {
+    
+    NSUInteger filled = MIN(atomic_load_explicit(&chunk->filled, memory_order_relaxed), chunk->length);
+    
+    for (NSUInteger slot = 0; slot < filled; slot++) {
+        
+        if (chunk->objects[slot]) {
+            
+            CFRelease(chunk->objects[slot]);
+            chunk->objects[slot] = NULL;
+            
+        }
+        
+    }
+    
+}
+
+static void SQChunkRelease(SQChunk *chunk) {
+    
+    if (atomic_fetch_sub_explicit(&chunk->references, 1, memory_order_acq_rel) != 1)
+        return;
+    
+    SQChunkClear(chunk);
+    
+    if (chunk->storage)
+        CFRelease(chunk->storage);
+    
+    free(chunk);
+    
+}
+
+#pragma mark - Chunk Indexes
+
+static SQChunkIndex *SQChunkIndexCreate(NSUInteger minimumCapacity) {
+    
+    NSUInteger capacity = 4;
+    
+    while (capacity < minimumCapacity) {
+        
+        capacity <<= 1;
+        
+    }
+    
+    SQChunkIndex *index = calloc(1, sizeof(SQChunkIndex) + capacity * sizeof(SQChunk *));
+    atomic_init(&index->references, 1);
+    index->capacity = capacity;
+    
+    return index;
+    
+}
+
+static void SQChunkIndexRelease(SQChunkIndex *index) {
+    
+    if (atomic_fetch_sub_explicit(&index->references, 1, memory_order_acq_rel) != 1)
+        return;
+    
+    for (NSUInteger i = 0; i < index->capacity; i++) {
+        
+        if (index->chunks[i])
+            SQChunkRelease(index->chunks[i]);
+        
+    }
+    
+    free(index);
+    
+}
+
+NS_INLINE BOOL SQChunkIndexIsExclusive(SQChunkIndex *index) {
+    
+    return atomic_load_explicit(&index->references, memory_order_acquire) == 1;
+    
+}
+
+NS_INLINE NSUInteger SQChunkedBufferRingSlot(const SQChunkedBuffer *buffer, NSUInteger chunk) {
+    
+    return (buffer->head + chunk) & (buffer->index->capacity - 1);
+    
+}
+
+/**
+ The number of chunks the buffer can see, including a partially dequeued one at the front that it will append to next
+ 
+ @param buffer The buffer
+ @return The number of chunks
+ */
+NS_INLINE NSUInteger SQChunkedBufferVisibleChunks(const SQChunkedBuffer *buffer) {
+    
+    return (buffer->start + buffer->count + SQChunkCapacity - 1) / SQChunkCapacity;
+    
+}
+
+/**
+ Make sure the buffer has an index of its own, with room for a chunk at the given position
+ 
+ @param buffer The buffer
+ @param chunk The chunk position that needs to exist, counted from the buffer's first chunk
+ @return The ring slot for the chunk
+ */
+static NSUInteger SQChunkedBufferPrepareIndex(SQChunkedBuffer *buffer, NSUInteger chunk) {
+    
+    SQChunkIndex *index = buffer->index;
+    
+    if (!index) {
+        
+        buffer->index = SQChunkIndexCreate(chunk + 1);
+        buffer->head = 0;
+        
+        return chunk;
+        
+    }
+    
+    BOOL exclusive = SQChunkIndexIsExclusive(index);
+    
+    if (exclusive && chunk < index->capacity)
+        return SQChunkedBufferRingSlot(buffer, chunk);
+    
+    // Either the index is shared, or the ring is full. Move the chunks we can see, in order, to the front of a new ring.
+    NSUInteger visible = SQChunkedBufferVisibleChunks(buffer);
+    SQChunkIndex *copy = SQChunkIndexCreate(MAX(chunk + 1, 2 * (exclusive ? index->capacity : visible)));
+    
+    for (NSUInteger i = 0; i < visible; i++) {
+        
+        NSUInteger slot = SQChunkedBufferRingSlot(buffer, i);
+        copy->chunks[i] = index->chunks[slot];
+        
+        if (exclusive) {
+            
+            // Ownership moves to the new ring
+            index->chunks[slot] = NULL;
+            
+        } else {
+            
+            atomic_fetch_add_explicit(&copy->chunks[i]->references, 1, memory_order_relaxed);
+            
+        }
+        
+    }
+    
+    // Drops anything drained while the index was shared, too
+    SQChunkIndexRelease(index);
+    
+    buffer->index = copy;
+    buffer->head = 0;
+    
+    return chunk;
+    
+}
+
+#pragma mark - Inline Storage
+
+NS_INLINE BOOL SQChunkedBufferIsInline(const SQChunkedBuffer *buffer) {
+    
+    return !buffer->index && buffer->inlineObjects;
+    
+}
+
+static SQChunk *SQChunkedBufferInstallChunk(SQChunkedBuffer *buffer, NSUInteger position);
+
+/**
+ Move the objects out of the inline storage into chunks, references and all
+ 
+ @param buffer The buffer, which must be using its inline storage
+ */
+static void SQChunkedBufferSpill(SQChunkedBuffer *buffer) {
+    
+    const void **objects = buffer->inlineObjects + buffer->start;
+    NSUInteger count = buffer->count;
+    
+    buffer->start = 0;
+    buffer->count = 0;
+    
+    for (NSUInteger location = 0; location < count; location += SQChunkCapacity) {
+        
+        NSUInteger length = MIN(SQChunkCapacity, count - location);
+        SQChunk *chunk = SQChunkedBufferInstallChunk(buffer, location / SQChunkCapacity);
+        
+        memcpy(chunk->objects, objects + location, length * sizeof(void *));
+        atomic_store_explicit(&chunk->filled, length, memory_order_relaxed);
+        buffer->count += length;
+        
+    }
+    
+}
+
+/**
+ Make room for a number of objects at the back of the inline storage, sliding what's there to the front if that's enough
+ 
+ @param buffer The buffer, which must be using its inline storage
+ @param count The number of objects
+ @return YES if there's room, NO if the objects have to go in chunks
+ */
+static BOOL SQChunkedBufferReserveInline(SQChunkedBuffer *buffer, NSUInteger count) {
+    
+    if (buffer->start + buffer->count + count <= buffer->inlineCapacity)
+        return YES;
+    
+    if (buffer->count + count > buffer->inlineCapacity)
+        return NO;
+    
+    memmove(buffer->inlineObjects, buffer->inlineObjects + buffer->start, buffer->count * sizeof(void *));
+    buffer->start = 0;
+    
+    return YES;
+    
+}
+
+#pragma mark - Buffers
+
+void SQChunkedBufferInit(SQChunkedBuffer *buffer) {
+    
+    buffer->index = NULL;
+    buffer->head = 0;
+    buffer->start = 0;
+    buffer->count = 0;
+    buffer->spare = NULL;
+    buffer->inlineObjects = NULL;
+    buffer->inlineCapacity = 0;
+    buffer->mutations = 0;
+    
+}
+
+void SQChunkedBufferInitWithInlineStorage(SQChunkedBuffer *buffer, const void **storage, NSUInteger capacity) {
+    
+    SQChunkedBufferInit(buffer);
+    buffer->inlineObjects = storage;
+    buffer->inlineCapacity = capacity;
+    
+}
+
+void SQChunkedBufferInitNoCopy(SQChunkedBuffer *buffer, const void **objects, NSUInteger count, BOOL freeWhenDone) {
+    
+    SQChunkedBufferInit(buffer);
+    
+    if (count == 0) {
+        
+        if (freeWhenDone)
+            free(objects);
+        
+        return;
+        
+    }
+    
+    // Every chunk is a window onto the same array, which is freed (or not) along with the last of them
+    NSData *storage = [NSData dataWithBytesNoCopy:objects length:count * sizeof(void *) freeWhenDone:freeWhenDone];
+    NSUInteger chunks = (count + SQChunkCapacity - 1) / SQChunkCapacity;
+    
+    buffer->index = SQChunkIndexCreate(chunks);
+    
+    for (NSUInteger i = 0; i < chunks; i++) {
+        
+        buffer->index->chunks[i] = SQChunkCreateAdopted((__bridge CFTypeRef)storage, objects + i * SQChunkCapacity, MIN(SQChunkCapacity, count - i * SQChunkCapacity));
+        
+    }
+    
+    buffer->count = count;
+    
+}
+
+void SQChunkedBufferDestroy(SQChunkedBuffer *buffer) {
+    
+    if (buffer->index) {
+        
+        SQChunkIndexRelease(buffer->index);
+        
+    } else {
+        
+        for (NSUInteger i = 0; i < buffer->count; i++) {
+            
+            CFRelease(buffer->inlineObjects[buffer->start + i]);
+            
+        }
+        
+    }
+    
+    if (buffer->spare)
+        SQChunkRelease(buffer->spare);
+    
+    unsigned long mutations = buffer->mutations;
+    
+    if (buffer->inlineObjects)
+        SQChunkedBufferInitWithInlineStorage(buffer, buffer->inlineObjects, buffer->inlineCapacity);
+    else
+        SQChunkedBufferInit(buffer);
+    
+    buffer->mutations = mutations + 1;
+    
+}
+
+void SQChunkedBufferInitWithBuffer(SQChunkedBuffer *buffer, const SQChunkedBuffer *source) {
+    
+    SQChunkedBufferInit(buffer);
+    
+    if (source->index) {
+        
+        atomic_fetch_add_explicit(&source->index->references, 1, memory_order_relaxed);
+        buffer->index = source->index;
+        buffer->head = source->head;
+        buffer->start = source->start;
+        buffer->count = source->count;
+        
+    } else {
+        
+        for (NSUInteger i = 0; i < source->count; i++) {
+            
+            SQChunkedBufferAppend(buffer, (__bridge id)source->inlineObjects[source->start + i]);
+            
+        }
+        
+    }
+    
+}
+
+/**
+ Put an empty chunk of our own at a chunk position, reusing the spare if there is one
+ 
+ @param buffer The buffer
+ @param position The chunk position, counted from the buffer's first chunk
+ @return The chunk
+ */
+static SQChunk *SQChunkedBufferInstallChunk(SQChunkedBuffer *buffer, NSUInteger position) {
+    
+    NSUInteger slot = SQChunkedBufferPrepareIndex(buffer, position);
+    SQChunk *chunk = buffer->spare ?: SQChunkCreate();
+    buffer->spare = NULL;
+    
+    // A chunk left behind from while the index was shared
+    if (buffer->index->chunks[slot])
+        SQChunkRelease(buffer->index->chunks[slot]);
+    
+    buffer->index->chunks[slot] = chunk;
+    
+    return chunk;
+    
+}
+
+/**
+ Give up a chunk that has been drained, keeping it as the spare if nobody else can see it
+ 
+ @param buffer The buffer
+ @param chunk The chunk
+ */
+static void SQChunkedBufferRecycleChunk(SQChunkedBuffer *buffer, SQChunk *chunk) {
+    
+    if (!buffer->spare && !chunk->storage && atomic_load_explicit(&chunk->references, memory_order_acquire) == 1) {
+        
+        SQChunkClear(chunk);
+        atomic_store_explicit(&chunk->filled, 0, memory_order_relaxed);
+        buffer->spare = chunk;
+        
+        return;
+        
+    }
+    
+    SQChunkRelease(chunk);
+    
+}
+
+void SQChunkedBufferAppend(SQChunkedBuffer *buffer, id object) {
+    
+    if (SQChunkedBufferIsInline(buffer)) {
+        
+        if (SQChunkedBufferReserveInline(buffer, 1)) {
+            
+            buffer->inlineObjects[buffer->start + buffer->count++] = CFBridgingRetain(object);
+            buffer->mutations++;
+            
+            return;
+            
+        }
+        
+        SQChunkedBufferSpill(buffer);
+        
+    }
+    
+    NSUInteger position = buffer->start + buffer->count;
+    NSUInteger offset = position % SQChunkCapacity;
+    SQChunk *chunk;
+    
+    if (offset == 0) {
+        
+        // Every chunk starts out owned by the buffer that created it
+        chunk = SQChunkedBufferInstallChunk(buffer, position / SQChunkCapacity);
+        
+    } else {
+        
+        chunk = buffer->index->chunks[SQChunkedBufferRingSlot(buffer, position / SQChunkCapacity)];
+        
+    }
+    
+    // Claim the next slot in the chunk. If a buffer we share the chunk with has already claimed it, copy what we can see into a chunk of our own.
+    NSUInteger expected = offset;
+    
+    if (!atomic_compare_exchange_strong_explicit(&chunk->filled, &expected, offset + 1, memory_order_acq_rel, memory_order_relaxed)) {
+        
+        NSUInteger slot = SQChunkedBufferPrepareIndex(buffer, position / SQChunkCapacity);
+        
+        SQChunk *copy = buffer->spare ?: SQChunkCreate();
+        buffer->spare = NULL;
+        NSUInteger first = position / SQChunkCapacity == 0 ? buffer->start : 0;
+        
+        for (NSUInteger i = first; i < offset; i++) {
+            
+            copy->objects[i] = CFRetain(chunk->objects[i]);
+            
+        }
+        
+        atomic_store_explicit(&copy->filled, offset + 1, memory_order_relaxed);
+        
+        buffer->index->chunks[slot] = copy;
+        SQChunkRelease(chunk);
+        chunk = copy;
+        
+    }
+    
+    chunk->objects[offset] = CFBridgingRetain(object);
+    buffer->count++;
+    buffer->mutations++;
+    
+}
+
+void SQChunkedBufferAppendObjects(SQChunkedBuffer *buffer, id<NSFastEnumeration> objects) {
+    
+    for (id object in objects) {
+        
+        SQChunkedBufferAppend(buffer, object);
+        
+    }
+    
+}
+
+void SQChunkedBufferAppendArray(SQChunkedBuffer *buffer, NSArray *objects) {
+    
+    NSUInteger count = objects.count;
+    NSUInteger location = 0;
+    
+    if (count > 0 && SQChunkedBufferIsInline(buffer)) {
+        
+        if (SQChunkedBufferReserveInline(buffer, count)) {
+            
+            const void **objectsBuffer = buffer->inlineObjects + buffer->start + buffer->count;
+            CFArrayGetValues((__bridge CFArrayRef)objects, CFRangeMake(0, (CFIndex)count), objectsBuffer);
+            
+            for (NSUInteger i = 0; i < count; i++) {
+                
+                CFRetain(objectsBuffer[i]);
+                
+            }
+            
+            buffer->count += count;
+            buffer->mutations++;
+            
+            return;
+            
+        }
+        
+        SQChunkedBufferSpill(buffer);
+        
+    }
+    
+    // Top up a partially filled chunk one object at a time, since it may be shared
+    while (location < count && (buffer->start + buffer->count) % SQChunkCapacity != 0) {
+        
+        SQChunkedBufferAppend(buffer, objects[location++]);
+        
+    }
+    
+    // Then fill fresh chunks, which are always our own, a whole chunk at a time
+    while (location < count) {
+        
+        NSUInteger length = MIN(SQChunkCapacity, count - location);
+        SQChunk *chunk = SQChunkedBufferInstallChunk(buffer, (buffer->start + buffer->count) / SQChunkCapacity);
+        
+        CFArrayGetValues((__bridge CFArrayRef)objects, CFRangeMake((CFIndex)location, (CFIndex)length), chunk->objects);
+        
+        for (NSUInteger i = 0; i < length; i++) {
+            
+            CFRetain(chunk->objects[i]);
+            
+        }
+        
+        atomic_store_explicit(&chunk->filled, length, memory_order_release);
+        buffer->count += length;
+        buffer->mutations++;
+        location += length;
+        
+    }
+    
+}
+
+id SQChunkedBufferRemoveFirst(SQChunkedBuffer *buffer) {
+    
+    if (buffer->count == 0)
+        return nil;
+    
+    if (!buffer->index) {
+        
+        // Inline storage is never shared, so the reference is always ours to take
+        id object = CFBridgingRelease(buffer->inlineObjects[buffer->start]);
+        buffer->count--;
+        buffer->start = buffer->count > 0 ? buffer->start + 1 : 0;
+        buffer->mutations++;
+        
+        return object;
+        
+    }
+    
+    NSUInteger slot = buffer->head;
+    NSUInteger offset = buffer->start;
+    SQChunkIndex *index = buffer->index;
+    SQChunk *chunk = index->chunks[slot];
+    BOOL exclusiveIndex = SQChunkIndexIsExclusive(index);
+    id object;
+    
+    if (exclusiveIndex && atomic_load_explicit(&chunk->references, memory_order_acquire) == 1) {
+        
+        // Nobody else can see this slot, so take the chunk's reference instead of retaining
+        object = CFBridgingRelease(chunk->objects[offset]);
+        chunk->objects[offset] = NULL;
+        
+    } else {
+        
+        object = (__bridge id)chunk->objects[offset];
+        
+    }
+    
+    buffer->start++;
+    buffer->count--;
+    buffer->mutations++;
+    
+    if (buffer->start == SQChunkCapacity) {
+        
+        // We've walked off the end of the chunk, so move on to the next one and let go of this one straight away
+        buffer->head = (buffer->head + 1) & (index->capacity - 1);
+        buffer->start = 0;
+        
+        if (exclusiveIndex) {
+            
+            index->chunks[slot] = NULL;
+            SQChunkedBufferRecycleChunk(buffer, chunk);
+            
+        }
+        
+    }
+    
+    return object;
+    
+}
+
+/**
+ Get the slot that holds the object at an index
+ 
+ @param buffer The buffer
+ @param index The index, which must be less than the buffer's count
+ @return The slot
+ */
+NS_INLINE const void **SQChunkedBufferSlot(const SQChunkedBuffer *buffer, NSUInteger index) {
+    
+    NSUInteger position = buffer->start + index;
+    
+    if (!buffer->index)
+        return &buffer->inlineObjects[position];
+    
+    return &buffer->index->chunks[SQChunkedBufferRingSlot(buffer, position / SQChunkCapacity)]->objects[position % SQChunkCapacity];
+    
+}
+
+/**
+ Whether the buffer is the only one that can see its index and every chunk in it, and so may rewrite them
+ 
+ @param buffer The buffer
+ @return YES if the buffer has exclusive access
+ */
+static BOOL SQChunkedBufferIsExclusive(const SQChunkedBuffer *buffer) {
+    
+    if (!buffer->index)
+        return YES;
+    
+    if (!SQChunkIndexIsExclusive(buffer->index))
+        return NO;
+    
+    NSUInteger visible = SQChunkedBufferVisibleChunks(buffer);
+    
+    for (NSUInteger i = 0; i < visible; i++) {
+        
+        if (atomic_load_explicit(&buffer->index->chunks[SQChunkedBufferRingSlot(buffer, i)]->references, memory_order_acquire) != 1)
+            return NO;
+        
+    }
+    
+    return YES;
+    
+}
+
+NSUInteger SQChunkedBufferRemoveMarkedObjects(SQChunkedBuffer *buffer, const uint8_t *marks) {
+    
+    NSUInteger count = buffer->count;
+    
+    if (count == 0)
+        return 0;
+    
+    BOOL exclusive = SQChunkedBufferIsExclusive(buffer);
+    SQChunkedBuffer survivors;
+    
+    if (!exclusive) {
+        
+        // Somebody else can see our chunks, so build the result off to the side and leave theirs alone
+        SQChunkedBufferInit(&survivors);
+        
+    }
+    
+    NSUInteger visible = exclusive && buffer->index ? SQChunkedBufferVisibleChunks(buffer) : 0;
+    NSUInteger write = 0;
+    
+    for (NSUInteger read = 0; read < count; read++) {
+        
+        const void **slot = SQChunkedBufferSlot(buffer, read);
+        
+        if (marks[read]) {
+            
+            if (exclusive) {
+                
+                CFRelease(*slot);
+                *slot = NULL;
+                
+            }
+            
+            continue;
+            
+        }
+        
+        if (!exclusive) {
+            
+            SQChunkedBufferAppend(&survivors, (__bridge id)*slot);
+            
+        } else if (write != read) {
+            
+            *SQChunkedBufferSlot(buffer, write) = *slot;
+            *slot = NULL;
+            
+        }
+        
+        write++;
+        
+    }
+    
+    if (write == count) {
+        
+        if (!exclusive)
+            SQChunkedBufferDestroy(&survivors);
+        
+        return 0;
+        
+    }
+    
+    if (!exclusive) {
+        
+        // Trade our view of the shared chunks for the survivors, keeping our inline storage for later
+        const void **inlineObjects = buffer->inlineObjects;
+        NSUInteger inlineCapacity = buffer->inlineCapacity;
+        unsigned long mutations = buffer->mutations;
+        
+        SQChunkedBufferDestroy(buffer);
+        *buffer = survivors;
+        buffer->inlineObjects = inlineObjects;
+        buffer->inlineCapacity = inlineCapacity;
+        buffer->mutations = mutations + 1;
+        
+        return count - write;
+        
+    }
+    
+    buffer->count = write;
+    buffer->mutations++;
+    
+    if (!buffer->index) {
+        
+        if (write == 0)
+            buffer->start = 0;
+        
+        return count - write;
+        
+    }
+    
+    // Give up the chunks at the back that nothing is left in, and let the new last chunk be appended to where the survivors end
+    NSUInteger remaining = SQChunkedBufferVisibleChunks(buffer);
+    
+    for (NSUInteger i = remaining; i < visible; i++) {
+        
+        NSUInteger ringSlot = SQChunkedBufferRingSlot(buffer, i);
+        SQChunk *chunk = buffer->index->chunks[ringSlot];
+        buffer->index->chunks[ringSlot] = NULL;
+        SQChunkedBufferRecycleChunk(buffer, chunk);
+        
+    }
+    
+    NSUInteger end = (buffer->start + write) % SQChunkCapacity;
+    
+    if (remaining > 0 && end != 0) {
+        
+        SQChunk *last = buffer->index->chunks[SQChunkedBufferRingSlot(buffer, remaining - 1)];
+        
+        if (!last->storage) {
+            
+            // A buffer we used to share the chunk with may have appended past our end before letting go of it
+            NSUInteger filled = atomic_load_explicit(&last->filled, memory_order_relaxed);
+            
+            for (NSUInteger i = end; i < filled; i++) {
+                
+                if (last->objects[i]) {
+                    
+                    CFRelease(last->objects[i]);
+                    last->objects[i] = NULL;
+                    
+                }
+                
+            }
+            
+            atomic_store_explicit(&last->filled, end, memory_order_relaxed);
+            
+        }
+        
+    }
+    
+    return count - write;
+    
+}
+
+NSUInteger SQChunkedBufferEnumerate(SQChunkedBuffer *buffer, NSFastEnumerationState *state) {
+    
+    if (state->state == 0) {
+        
+        state->mutationsPtr = &buffer->mutations;
+        
+    }
+    
+    NSUInteger index = state->state;
+    
+    if (index >= buffer->count)
+        return 0;
+    
+    if (!buffer->index) {
+        
+        state->itemsPtr = (__unsafe_unretained id *)(void *)(buffer->inlineObjects + buffer->start + index);
+        state->state = buffer->count;
+        
+        return buffer->count - index;
+        
+    }
+    
+    // Hand out the rest of the current chunk in one batch
+    NSUInteger position = buffer->start + index;
+    NSUInteger offset = position % SQChunkCapacity;
+    NSUInteger length = MIN(SQChunkCapacity - offset, buffer->count - index);
+    
+    state->itemsPtr = (__unsafe_unretained id *)(void *)&buffer->index->chunks[SQChunkedBufferRingSlot(buffer, position / SQChunkCapacity)]->objects[offset];
+    state->state = index + length;
+    
+    return length;
+    
+}
+
+NSArray *SQChunkedBufferCopyArray(const SQChunkedBuffer *buffer) {
+    
+    if (buffer->count == 0)
+        return @[];
+    
+    __unsafe_unretained id *objects = (__unsafe_unretained id *)malloc(buffer->count * sizeof(id));
+    
+    for (NSUInteger i = 0; i < buffer->count; i++) {
+        
+        objects[i] = SQChunkedBufferObjectAtIndex(buffer, i);
+        
+    }
+    
+    NSArray *array = [NSArray arrayWithObjects:objects count:buffer->count];
+    free(objects);
+    
+    return array;
+    
+}
@@ -0,0 +1,88 @@
+//
+//  SQConcurrentTest.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Storage for test results, one byte per object, that a collection keeps between calls so purging it regularly doesn't allocate every time
+ */
+typedef struct SQTestResults {
+
+    /**
+     The storage, or NULL
+     */
+    uint8_t * _Nullable bytes;
+
+    /**
+     The number of results the storage has room for
+     */
+    NSUInteger capacity;
+
+} SQTestResults;
+
+/**
+ Take the storage out of a collection's results, growing it to a count first if needed
+
+ @discussion The storage is detached while it's in use, so a test that purges the same collection again gets storage of its own instead of overwriting the results it's part of.
+ @param cache The collection's results
+ @param count The number of objects
+ @return The storage, with room for at least count results
+ */
+FOUNDATION_EXTERN SQTestResults SQTestResultsTake(SQTestResults *cache, NSUInteger count);
+
+/**
+ Hand storage back to a collection's results once the results have been used
+
+ @param cache The collection's results
+ @param results The storage from SQTestResultsTake
+ */
+FOUNDATION_EXTERN void SQTestResultsReturn(SQTestResults *cache, SQTestResults results);
+
+/**
+ Free a collection's results
+
+ @param cache The collection's results
+ */
+FOUNDATION_EXTERN void SQTestResultsDestroy(SQTestResults *cache);
+
+/**
+ Evaluate a test for every object in a collection in parallel, for tests expensive enough to be worth spreading across cores
+
+ @discussion The objects are split into a few batches per core. Setting stop is honored on a best-effort basis, the way NSEnumerationConcurrent is: batches that are already running finish the object they're on, and objects that are never tested get a result of NO.
+ @param results Room for one result per object
+ @param count The number of objects
+ @param objectAtIndex A block that returns the object at an index, which must be safe to call from any thread
+ @param predicate The test
+ */
+FOUNDATION_EXTERN void SQEvaluateTestConcurrently(uint8_t *results, NSUInteger count, NS_NOESCAPE id (^objectAtIndex)(NSUInteger index), NS_NOESCAPE BOOL (^predicate)(id object, NSUInteger index, BOOL *stop));
+
+/**
+ Evaluate a test for every object in a collection, in order, or in parallel with NSEnumerationConcurrent
+
+ @discussion In order, objects after the one where stop is set aren't tested, and get a result of NO. In parallel, stop is best-effort, as for SQEvaluateTestConcurrently, so objects after it may already have been tested. Evaluation also stops, without reading another object, as soon as the collection's mutation count changes, so a test that mutates the collection can't make it read a slot that's gone. The caller should check the count afterwards and raise.
+ @param results Room for one result per object
+ @param count The number of objects
+ @param opts NSEnumerationConcurrent evaluates the test in parallel. Other options are ignored.
+ @param mutationsPtr The collection's mutation count
+ @param objectAtIndex A block that returns the object at an index, which must be safe to call from any thread when evaluating in parallel
+ @param predicate The test
+ */
+FOUNDATION_EXTERN void SQEvaluateTest(uint8_t *results, NSUInteger count, NSEnumerationOptions opts, const unsigned long *mutationsPtr, NS_NOESCAPE id (^objectAtIndex)(NSUInteger index), NS_NOESCAPE BOOL (^predicate)(id object, NSUInteger index, BOOL *stop));
+
+/**
+ Enumerate the runs of objects that a set of results marks for removal
+
+ @param results The results, one byte per object
+ @param count The number of objects
+ @param block Called for each run, with its range after the runs before it have been closed up
+ */
+FOUNDATION_EXTERN void SQEnumerateRemovedRanges(const uint8_t *results, NSUInteger count, NS_NOESCAPE void (^block)(NSRange range));
+
+NS_ASSUME_NONNULL_END
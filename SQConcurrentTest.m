@@ -0,0 +1,152 @@
+//
+//  SQConcurrentTest.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "SQConcurrentTest.h"
+
+#import <stdatomic.h>
+
+SQTestResults SQTestResultsTake(SQTestResults *cache, NSUInteger count) {
+    
+    SQTestResults results = *cache;
+    cache->bytes = NULL;
+    cache->capacity = 0;
+    
+    if (results.capacity < count) {
+        
+        free(results.bytes);
+        results.capacity = MAX(count, 64);
+        results.bytes = malloc(results.capacity);
+        
+    }
+    
+    return results;
+    
+}
+
+void SQTestResultsReturn(SQTestResults *cache, SQTestResults results) {
+    
+    // A nested purge may have handed back its own storage already, so keep whichever is larger
+    if (results.capacity >= cache->capacity) {
+        
+        free(cache->bytes);
+        *cache = results;
+        
+    } else {
+        
+        free(results.bytes);
+        
+    }
+    
+}
+
+void SQTestResultsDestroy(SQTestResults *cache) {
+    
+    free(cache->bytes);
+    cache->bytes = NULL;
+    cache->capacity = 0;
+    
+}
+
+void SQEvaluateTestConcurrently(uint8_t *results, NSUInteger count, id (^objectAtIndex)(NSUInteger), BOOL (^predicate)(id, NSUInteger, BOOL *)) {
+    
+    // Objects that are never tested get NO
+    memset(results, 0, count);
+    
+    if (count == 0)
+        return;
+    
+    // A few batches per core, so one slow batch doesn't leave the others idle
+    NSUInteger batches = MIN(count, 8 * NSProcessInfo.processInfo.activeProcessorCount);
+    NSUInteger stride = (count + batches - 1) / batches;
+    
+    _Atomic(BOOL) stopped = NO;
+    _Atomic(BOOL) *stoppedPointer = &stopped;
+    
+    dispatch_apply((count + stride - 1) / stride, DISPATCH_APPLY_AUTO, ^(size_t batch) {
+        
+        NSUInteger end = MIN(count, (batch + 1) * stride);
+        
+        for (NSUInteger i = batch * stride; i < end && !atomic_load_explicit(stoppedPointer, memory_order_relaxed); i++) {
+            
+            BOOL stop = NO;
+            results[i] = predicate(objectAtIndex(i), i, &stop) ? 1 : 0;
+            
+            if (stop)
+                atomic_store_explicit(stoppedPointer, YES, memory_order_relaxed);
+            
+        }
+        
+    });
+    
+}
+
+void SQEvaluateTest(uint8_t *results, NSUInteger count, NSEnumerationOptions opts, const unsigned long *mutationsPtr, id (^objectAtIndex)(NSUInteger), BOOL (^predicate)(id, NSUInteger, BOOL *)) {
+    
+    unsigned long mutations = *mutationsPtr;
+    
+    if (opts & NSEnumerationConcurrent) {
+        
+        SQEvaluateTestConcurrently(results, count, ^id(NSUInteger index) {
+            
+            return *mutationsPtr == mutations ? objectAtIndex(index) : nil;
+            
+        }, ^BOOL(id object, NSUInteger index, BOOL *stop) {
+            
+            if (!object) {
+                
+                *stop = YES;
+                return NO;
+                
+            }
+            
+            return predicate(object, index, stop);
+            
+        });
+        
+        return;
+        
+    }
+    
+    memset(results, 0, count);
+    BOOL stop = NO;
+    
+    for (NSUInteger i = 0; i < count && !stop && *mutationsPtr == mutations; i++) {
+        
+        results[i] = predicate(objectAtIndex(i), i, &stop) ? 1 : 0;
+        
+    }
+    
+}
+
+void SQEnumerateRemovedRanges(const uint8_t *results, NSUInteger count, void (^block)(NSRange)) {
+    
+    NSUInteger kept = 0;
+    NSUInteger runLength = 0;
+    
+    for (NSUInteger i = 0; i < count; i++) {
+        
+        if (results[i]) {
+            
+            runLength++;
+            
+            continue;
+            
+        }
+        
+        if (runLength > 0)
+            block(NSMakeRange(kept, runLength));
+        
+        runLength = 0;
+        kept++;
+        
+    }
+    
+    if (runLength > 0)
+        block(NSMakeRange(kept, runLength));
+    
+}
@@ -0,0 +1,173 @@
+//
+//  SQContiguousBuffer.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A growable C array of retained objects, for LIFO storage
+ */
+typedef struct SQContiguousBuffer {
+
+    /**
+     The objects, each retained once by the buffer
+     */
+    const void * _Nullable * _Nullable objects;
+
+    /**
+     The number of objects in the buffer
+     */
+    NSUInteger count;
+
+    /**
+     The number of objects the storage has room for
+     */
+    NSUInteger capacity;
+
+    /**
+     Whether the buffer may write to the storage: it allocated it itself, adopted it with freeWhenDone, or it's the inline storage. Storage the buffer doesn't own is copied to the heap the first time it needs to grow.
+     */
+    BOOL ownsStorage;
+
+    /**
+     Storage inside the object that embeds the buffer, used before anything is allocated, or NULL. It's moved to the heap rather than realloc'd when it runs out, and is never freed.
+     */
+    const void * _Nullable * _Nullable inlineObjects;
+
+    /**
+     The number of objects the inline storage has room for
+     */
+    NSUInteger inlineCapacity;
+
+    /**
+     A counter that changes on every mutation, for NSFastEnumeration
+     */
+    unsigned long mutations;
+
+} SQContiguousBuffer;
+
+/**
+ Initialize an empty buffer
+
+ @param buffer The buffer
+ @param capacity The number of objects to make room for up front
+ */
+FOUNDATION_EXTERN void SQContiguousBufferInit(SQContiguousBuffer *buffer, NSUInteger capacity);
+
+/**
+ Initialize an empty buffer that stores its first objects in memory the caller provides, and only allocates once they don't fit
+
+ @param buffer The buffer
+ @param storage The inline storage, which must outlive the buffer
+ @param capacity The number of objects the inline storage has room for
+ */
+FOUNDATION_EXTERN void SQContiguousBufferInitWithInlineStorage(SQContiguousBuffer *buffer, const void * _Nullable * _Nonnull storage, NSUInteger capacity);
+
+/**
+ Initialize a buffer that takes over a C array of retained objects, without copying it
+
+ @param buffer The buffer
+ @param objects The C array. The buffer takes over the reference to each object.
+ @param count The number of objects
+ @param freeWhenDone YES if the C array was allocated with malloc and the buffer should free it, NO if the caller keeps it alive for as long as the buffer uses it
+ */
+FOUNDATION_EXTERN void SQContiguousBufferInitNoCopy(SQContiguousBuffer *buffer, const void * _Nullable * _Nullable objects, NSUInteger count, BOOL freeWhenDone);
+
+/**
+ Release everything the buffer references, and leave it empty, back on its inline storage if it has any
+
+ @param buffer The buffer
+ */
+FOUNDATION_EXTERN void SQContiguousBufferDestroy(SQContiguousBuffer *buffer);
+
+/**
+ Make sure the buffer has room for a number of objects, in storage it owns
+
+ @param buffer The buffer
+ @param capacity The number of objects
+ */
+FOUNDATION_EXTERN void SQContiguousBufferReserve(SQContiguousBuffer *buffer, NSUInteger capacity);
+
+/**
+ Append an object to the back of the buffer
+
+ @param buffer The buffer
+ @param object The object
+ */
+NS_INLINE void SQContiguousBufferAppend(SQContiguousBuffer *buffer, id object) {
+
+    if (buffer->count == buffer->capacity || !buffer->ownsStorage)
+        SQContiguousBufferReserve(buffer, buffer->count + 1);
+
+    buffer->objects[buffer->count++] = CFBridgingRetain(object);
+    buffer->mutations++;
+
+}
+
+/**
+ Append every object in an array to the back of the buffer, in a single pass
+
+ @param buffer The buffer
+ @param objects The array
+ */
+FOUNDATION_EXTERN void SQContiguousBufferAppendArray(SQContiguousBuffer *buffer, NSArray *objects);
+
+/**
+ Remove the object at the back of the buffer
+
+ @param buffer The buffer
+ @return The object, or nil if the buffer is empty
+ */
+NS_INLINE id _Nullable SQContiguousBufferRemoveLast(SQContiguousBuffer *buffer) {
+
+    if (buffer->count == 0)
+        return nil;
+
+    buffer->mutations++;
+
+    return CFBridgingRelease(buffer->objects[--buffer->count]);
+
+}
+
+/**
+ Remove every object above a count from the back of the buffer, releasing them in one pass
+
+ @param buffer The buffer
+ @param count The number of objects to keep, which must not be more than the buffer's count
+ */
+FOUNDATION_EXTERN void SQContiguousBufferTruncate(SQContiguousBuffer *buffer, NSUInteger count);
+
+/**
+ Remove every object marked for removal, closing up the survivors in place in a single pass
+
+ @discussion Marking is left to the caller, so the test has run to completion, and can't see a half-compacted buffer, before anything is released.
+ @param buffer The buffer
+ @param marks One byte per object in the buffer, nonzero for each object to remove
+ @return The number of objects removed
+ */
+FOUNDATION_EXTERN NSUInteger SQContiguousBufferRemoveMarkedObjects(SQContiguousBuffer *buffer, const uint8_t *marks);
+
+/**
+ Implement NSFastEnumeration over a buffer, handing out its storage directly
+
+ @param buffer The buffer
+ @param state The enumeration state
+ @return The number of objects in the returned batch
+ */
+FOUNDATION_EXTERN NSUInteger SQContiguousBufferEnumerate(SQContiguousBuffer *buffer, NSFastEnumerationState *state);
+
+/**
+ Copy the contents of the buffer into an NSArray
+
+ @param buffer The buffer
+ @return The array
+ */
+FOUNDATION_EXTERN NSArray *SQContiguousBufferCopyArray(const SQContiguousBuffer *buffer);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,188 @@
+//
+//  SQContiguousBuffer.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "SQContiguousBuffer.h"
+
+void SQContiguousBufferInit(SQContiguousBuffer *buffer, NSUInteger capacity) {
+    
+    buffer->objects = capacity > 0 ? malloc(capacity * sizeof(void *)) : NULL;
+    buffer->count = 0;
+    buffer->capacity = capacity;
+    buffer->ownsStorage = YES;
+    buffer->inlineObjects = NULL;
+    buffer->inlineCapacity = 0;
+    buffer->mutations = 0;
+    
+}
+
+void SQContiguousBufferInitWithInlineStorage(SQContiguousBuffer *buffer, const void **storage, NSUInteger capacity) {
+    
+    SQContiguousBufferInit(buffer, 0);
+    buffer->objects = storage;
+    buffer->capacity = capacity;
+    buffer->inlineObjects = storage;
+    buffer->inlineCapacity = capacity;
+    
+}
+
+void SQContiguousBufferInitNoCopy(SQContiguousBuffer *buffer, const void **objects, NSUInteger count, BOOL freeWhenDone) {
+    
+    buffer->objects = objects;
+    buffer->count = count;
+    buffer->capacity = count;
+    buffer->ownsStorage = freeWhenDone;
+    buffer->inlineObjects = NULL;
+    buffer->inlineCapacity = 0;
+    buffer->mutations = 0;
+    
+}
+
+void SQContiguousBufferDestroy(SQContiguousBuffer *buffer) {
+    
+    for (NSUInteger i = 0; i < buffer->count; i++) {
+        
+        CFRelease(buffer->objects[i]);
+        
+    }
+    
+    if (buffer->ownsStorage && buffer->objects != buffer->inlineObjects)
+        free(buffer->objects);
+    
+    unsigned long mutations = buffer->mutations;
+    
+    if (buffer->inlineObjects)
+        SQContiguousBufferInitWithInlineStorage(buffer, buffer->inlineObjects, buffer->inlineCapacity);
+    else
+        SQContiguousBufferInit(buffer, 0);
+    
+    buffer->mutations = mutations + 1;
+    
+}
+
+void SQContiguousBufferReserve(SQContiguousBuffer *buffer, NSUInteger capacity) {
+    
+    if (buffer->ownsStorage && capacity <= buffer->capacity)
+        return;
+    
+    NSUInteger newCapacity = MAX(MAX(capacity, 2 * buffer->capacity), 8);
+    
+    if (buffer->ownsStorage && buffer->objects != buffer->inlineObjects) {
+        
+        buffer->objects = realloc(buffer->objects, newCapacity * sizeof(void *));
+        
+    } else {
+        
+        // Move off storage we've only borrowed, or inline storage we've outgrown, the first time we need to write past it
+        const void **objects = malloc(newCapacity * sizeof(void *));
+        memcpy(objects, buffer->objects, buffer->count * sizeof(void *));
+        buffer->objects = objects;
+        buffer->ownsStorage = YES;
+        
+    }
+    
+    buffer->capacity = newCapacity;
+    
+}
+
+void SQContiguousBufferAppendArray(SQContiguousBuffer *buffer, NSArray *objects) {
+    
+    NSUInteger count = objects.count;
+    
+    if (count == 0)
+        return;
+    
+    SQContiguousBufferReserve(buffer, buffer->count + count);
+    
+    // Copy the pointers straight into our storage, then take a reference to each
+    CFArrayGetValues((__bridge CFArrayRef)objects, CFRangeMake(0, (CFIndex)count), buffer->objects + buffer->count);
+    
+    for (NSUInteger i = buffer->count; i < buffer->count + count; i++) {
+        
+        CFRetain(buffer->objects[i]);
+        
+    }
+    
+    buffer->count += count;
+    buffer->mutations++;
+    
+}
+
+void SQContiguousBufferTruncate(SQContiguousBuffer *buffer, NSUInteger count) {
+    
+    if (count >= buffer->count)
+        return;
+    
+    // Release from the top down, the same order popping one at a time would
+    for (NSUInteger i = buffer->count; i > count; i--) {
+        
+        CFRelease(buffer->objects[i - 1]);
+        
+    }
+    
+    buffer->count = count;
+    buffer->mutations++;
+    
+}
+
+NSUInteger SQContiguousBufferRemoveMarkedObjects(SQContiguousBuffer *buffer, const uint8_t *marks) {
+    
+    NSUInteger count = buffer->count;
+    
+    if (count == 0)
+        return 0;
+    
+    // We're about to write, so move off any storage we've only borrowed
+    SQContiguousBufferReserve(buffer, count);
+    
+    const void **objects = buffer->objects;
+    NSUInteger write = 0;
+    
+    for (NSUInteger read = 0; read < count; read++) {
+        
+        if (marks[read]) {
+            
+            CFRelease(objects[read]);
+            
+            continue;
+            
+        }
+        
+        objects[write++] = objects[read];
+        
+    }
+    
+    buffer->count = write;
+    
+    if (write < count)
+        buffer->mutations++;
+    
+    return count - write;
+    
+}
+
+NSUInteger SQContiguousBufferEnumerate(SQContiguousBuffer *buffer, NSFastEnumerationState *state) {
+    
+    if (state->state != 0)
+        return 0;
+    
+    state->mutationsPtr = &buffer->mutations;
+    state->itemsPtr = (__unsafe_unretained id *)(void *)buffer->objects;
+    state->state = 1;
+    
+    return buffer->count;
+    
+}
+
+NSArray *SQContiguousBufferCopyArray(const SQContiguousBuffer *buffer) {
+    
+    if (buffer->count == 0)
+        return @[];
+    
+    return [NSArray arrayWithObjects:(__unsafe_unretained id *)(void *)buffer->objects count:buffer->count];
+    
+}
@@ -0,0 +1,66 @@
+//
+//  SQDequeueRequest.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A pending asynchronous dequeue, parked on a queue until objects arrive.
+
+ @discussion Requests are linked into a FIFO list owned by the queue and are only ever touched under the queue's lock, so the oldest request is always the next to be fulfilled. A request doubles as the cancellation token handed back to the caller.
+ */
+@interface SQDequeueRequest : NSObject
+
+/**
+ Create a request
+
+ @param queue The queue to call the completion on
+ @param maximumCount The most objects the request will accept
+ @param completion The completion, called once with between one and `maximumCount` objects
+ @return The request
+ */
+- (instancetype)initWithQueue:(dispatch_queue_t)queue maximumCount:(NSUInteger)maximumCount completion:(void (^)(NSArray *objects))completion NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ The Queue that made the request, which is the only one that may cancel it
+ */
+@property (nonatomic, weak, nullable) id owner;
+
+/**
+ The most objects the request will accept
+ */
+@property (nonatomic, readonly) NSUInteger maximumCount;
+
+/**
+ Whether the request is waiting in a queue's list
+ */
+@property (nonatomic, getter=isPending) BOOL pending;
+
+/**
+ The next request in the list, which the list retains
+ */
+@property (nonatomic, strong, nullable) SQDequeueRequest *next;
+
+/**
+ The previous request in the list, which is kept alive by the list
+ */
+@property (nonatomic, unsafe_unretained, nullable) SQDequeueRequest *previous;
+
+/**
+ Call the completion asynchronously with the dequeued objects. Must be called at most once, outside of the queue's lock.
+
+ @param objects The objects
+ */
+- (void)fulfillWithObjects:(NSArray *)objects;
+
+@end
+
+NS_ASSUME_NONNULL_END
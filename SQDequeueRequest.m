@@ -0,0 +1,53 @@
+//
+//  SQDequeueRequest.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "SQDequeueRequest.h"
+
+@implementation SQDequeueRequest {
+    
+    dispatch_queue_t _queue;
+    void (^_completion)(NSArray *objects);
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue maximumCount:(NSUInteger)maximumCount completion:(void (^)(NSArray *))completion {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _queue = queue;
+        _maximumCount = maximumCount;
+        _completion = [completion copy];
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Public Instance Methods
+
+- (void)fulfillWithObjects:(NSArray *)objects {
+    
+    void (^completion)(NSArray *) = _completion;
+    
+    // Let go of the completion right away, since it usually captures the queue that holds the token
+    _completion = nil;
+    
+    dispatch_async(_queue, ^{
+        
+        completion(objects);
+        
+    });
+    
+}
+
+@end
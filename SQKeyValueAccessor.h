@@ -0,0 +1,101 @@
+//
+//  SQKeyValueAccessor.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A resolved key-value coding accessor for a single class and key.
+
+ @discussion Accessors are resolved once per class and key, following the same search order as NSKeyValueCoding, and cached. Each cached accessor remembers the implementation of every selector its resolution looked at, and is resolved again if any of them has changed since, so swizzled or added methods, and new classes reusing a disposed class's address, are picked up. A class with collection accessors for a key (countOf<Key> with objectIn<Key>AtIndex:, <key>AtIndexes:, or enumeratorOf<Key> and memberOf<Key>:) is left to standard KVC for that key, which returns a proxy collection. Getters and setters are resolved to an IMP or an instance variable offset, for object and scalar number types. Keys that can't be resolved this way (struct types, undefined keys, etc.) are forwarded to standard KVC on each object.
+ */
+@interface SQKeyValueAccessor : NSObject
+
+/**
+ Get the cached accessor for a class and key
+
+ @param cls The class of the objects that will be accessed, as returned by object_getClass()
+ @param key The key
+ @return The accessor, or nil if the class customizes -valueForKey: or -setValue:forKey: and standard KVC must be used instead
+ */
++ (nullable instancetype)accessorForClass:(Class)cls key:(NSString *)key;
+
+/**
+ Get the value for the key from an object, boxing scalars the way KVC would
+
+ @param object The object, which must be an instance of the accessor's class
+ @return The value
+ */
+- (nullable id)valueForObject:(id)object;
+
+/**
+ Set the value for the key on an object, unboxing scalars the way KVC would
+
+ @note A nil value for a scalar key is forwarded to standard KVC, so that -setNilValueForKey: is honored
+ @param value The value
+ @param object The object, which must be an instance of the accessor's class
+ */
+- (void)setValue:(nullable id)value forObject:(id)object;
+
+/**
+ Get the value for the key from an object as a 64-bit integer, without boxing
+
+ @param object The object, which must be an instance of the accessor's class
+ @return The value, or 0 if the value is nil
+ */
+- (int64_t)int64ValueForObject:(id)object;
+
+/**
+ Get the value for the key from an object as a double, without boxing
+
+ @param object The object, which must be an instance of the accessor's class
+ @return The value, or 0 if the value is nil
+ */
+- (double)doubleValueForObject:(id)object;
+
+@end
+
+/**
+ Map a key over a collection, resolving the accessor once per class
+
+ @param objects The collection
+ @param count The number of objects in the collection
+ @param key The key, which must not be a collection operator
+ @return The values, with NSNull in place of nil, as -[NSArray valueForKey:] would return them
+ */
+FOUNDATION_EXTERN NSArray *SQValuesForKey(id<NSFastEnumeration> objects, NSUInteger count, NSString *key);
+
+/**
+ Set a value for a key on every object in a collection, resolving the accessor once per class
+
+ @param objects The collection
+ @param value The value
+ @param key The key
+ */
+FOUNDATION_EXTERN void SQSetValueForKey(id<NSFastEnumeration> objects, id _Nullable value, NSString *key);
+
+/**
+ Extract a key from every object in a collection into a buffer of 64-bit integers
+
+ @param objects The collection
+ @param key The key
+ @param buffer The buffer, which must have room for one value per object
+ */
+FOUNDATION_EXTERN void SQInt64ValuesForKey(id<NSFastEnumeration> objects, NSString *key, int64_t *buffer);
+
+/**
+ Extract a key from every object in a collection into a buffer of doubles
+
+ @param objects The collection
+ @param key The key
+ @param buffer The buffer, which must have room for one value per object
+ */
+FOUNDATION_EXTERN void SQDoubleValuesForKey(id<NSFastEnumeration> objects, NSString *key, double *buffer);
+
+NS_ASSUME_NONNULL_END
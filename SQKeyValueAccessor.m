@@ -0,0 +1,600 @@
+//
+//  SQKeyValueAccessor.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "SQKeyValueAccessor.h"
+
+#import <objc/runtime.h>
+#import <os/lock.h>
+
+/**
+ The most selectors an accessor's resolution depends on
+ */
+#define SQKeyValueAccessorMaxDependencies 16
+
+static os_unfair_lock SQKeyValueAccessorCacheLock = OS_UNFAIR_LOCK_INIT;
+static NSMapTable<Class, NSMutableDictionary<NSString *, id> *> *SQKeyValueAccessorCache;
+
+/**
+ Reduce an Objective-C type encoding to a single character, if it's one we can read and write directly
+ 
+ @param encoding The type encoding
+ @return The type character, or 0 if the type must go through standard KVC
+ */
+static char SQScalarTypeFromEncoding(const char *encoding) {
+    
+    if (!encoding)
+        return 0;
+    
+    // Skip method type qualifiers (const, in, inout, out, bycopy, byref, oneway)
+    while (*encoding && strchr("rnNoORV", *encoding))
+        encoding++;
+    
+    if (encoding[0] == '@')
+        return '@';
+    
+    if (encoding[0] && !encoding[1] && strchr("cCsSiIlLqQfdB", encoding[0]))
+        return encoding[0];
+    
+    return 0;
+    
+}
+
+// Read or write a scalar through the resolved IMP, or directly at the ivar's offset within the instance
+#define SQGetScalar(object, TYPE) \
+    (_getterIMP ? ((TYPE (*)(id, SEL))_getterIMP)(object, _getter) : *(TYPE *)((uint8_t *)(__bridge void *)(object) + ivar_getOffset(_getterIvar)))
+
+#define SQSetScalar(object, TYPE, value) \
+    do { \
+        if (_setterIMP) \
+            ((void (*)(id, SEL, TYPE))_setterIMP)(object, _setter, (value)); \
+        else \
+            *(TYPE *)((uint8_t *)(__bridge void *)(object) + ivar_getOffset(_setterIvar)) = (value); \
+    } while (0)
+
+@implementation SQKeyValueAccessor {
+    
+    NSString *_key;
+    
+    // Set if the class customizes KVC, so standard KVC must be used instead
+    BOOL _customized;
+    
+    // Every selector the resolution looked at, and the implementation it found for each, or the forwarding IMP if there was none. If any of them change, the accessor is resolved again.
+    SEL _dependencies[SQKeyValueAccessorMaxDependencies];
+    IMP _dependencyIMPs[SQKeyValueAccessorMaxDependencies];
+    NSUInteger _dependencyCount;
+    
+    SEL _getter;
+    IMP _getterIMP;
+    Ivar _getterIvar;
+    char _getterType;
+    
+    SEL _setter;
+    IMP _setterIMP;
+    Ivar _setterIvar;
+    char _setterType;
+    
+}
+
+#pragma mark - Public Class Methods
+
++ (instancetype)accessorForClass:(Class)cls key:(NSString *)key {
+    
+    os_unfair_lock_lock(&SQKeyValueAccessorCacheLock);
+    
+    if (!SQKeyValueAccessorCache) {
+        
+        SQKeyValueAccessorCache = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsObjectPointerPersonality
+                                                        valueOptions:NSPointerFunctionsStrongMemory];
+        
+    }
+    
+    NSMutableDictionary<NSString *, id> *accessors = [SQKeyValueAccessorCache objectForKey:cls];
+    SQKeyValueAccessor *accessor = accessors[key];
+    
+    os_unfair_lock_unlock(&SQKeyValueAccessorCacheLock);
+    
+    // Methods may have been swizzled or added since, or the class may be a new one at a disposed class's address
+    if (!accessor || ![accessor isCurrentForClass:cls]) {
+        
+        // Resolve outside of the lock, since +accessInstanceVariablesDirectly may run arbitrary code.
+        // Two threads racing to resolve the same key will produce identical accessors, so the last one in wins.
+        accessor = [[self alloc] initWithClass:cls key:key];
+        
+        os_unfair_lock_lock(&SQKeyValueAccessorCacheLock);
+        
+        accessors = [SQKeyValueAccessorCache objectForKey:cls];
+        
+        if (!accessors) {
+            
+            accessors = [NSMutableDictionary dictionary];
+            [SQKeyValueAccessorCache setObject:accessors forKey:cls];
+            
+        }
+        
+        accessors[[key copy]] = accessor;
+        
+        os_unfair_lock_unlock(&SQKeyValueAccessorCacheLock);
+        
+    }
+    
+    return accessor->_customized ? nil : accessor;
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithClass:(Class)cls key:(NSString *)key {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _key = [key copy];
+        
+        // Classes that customize KVC (collections, managed objects, proxies, etc.) are left to standard KVC
+        if ([self dependOnSelector:@selector(valueForKey:) ofClass:cls] != [NSObject instanceMethodForSelector:@selector(valueForKey:)] ||
+            [self dependOnSelector:@selector(setValue:forKey:) ofClass:cls] != [NSObject instanceMethodForSelector:@selector(setValue:forKey:)]) {
+            
+            _customized = YES;
+            return self;
+            
+        }
+        
+        if (key.length == 0 || [key hasPrefix:@"@"])
+            return self;
+        
+        NSString *capitalizedKey = [[key substringToIndex:1].uppercaseString stringByAppendingString:[key substringFromIndex:1]];
+        BOOL accessIvars = [cls accessInstanceVariablesDirectly];
+        BOOL foundGetter = NO;
+        BOOL foundSetter = NO;
+        
+        // Getter: -getKey, -key, -isKey, -_key, then _key, _isKey, key, isKey
+        for (NSString *name in @[[@"get" stringByAppendingString:capitalizedKey], key, [@"is" stringByAppendingString:capitalizedKey], [@"_" stringByAppendingString:key]]) {
+            
+            SEL selector = NSSelectorFromString(name);
+            [self dependOnSelector:selector ofClass:cls];
+            Method method = class_getInstanceMethod(cls, selector);
+            
+            if (!method || method_getNumberOfArguments(method) != 2)
+                continue;
+            
+            char *returnType = method_copyReturnType(method);
+            _getterType = SQScalarTypeFromEncoding(returnType);
+            free(returnType);
+            
+            if (_getterType) {
+                
+                _getter = selector;
+                _getterIMP = method_getImplementation(method);
+                
+            }
+            
+            foundGetter = YES;
+            break;
+            
+        }
+        
+        // Then the ordered and unordered collection accessors, for which KVC returns a proxy collection, so leave those to standard KVC
+        if (!foundGetter) {
+            
+            BOOL count = [self dependOnSelector:NSSelectorFromString([@"countOf" stringByAppendingString:capitalizedKey]) ofClass:cls] != _objc_msgForward;
+            BOOL objectAtIndex = [self dependOnSelector:NSSelectorFromString([NSString stringWithFormat:@"objectIn%@AtIndex:", capitalizedKey]) ofClass:cls] != _objc_msgForward;
+            BOOL objectsAtIndexes = [self dependOnSelector:NSSelectorFromString([key stringByAppendingString:@"AtIndexes:"]) ofClass:cls] != _objc_msgForward;
+            BOOL enumerator = [self dependOnSelector:NSSelectorFromString([@"enumeratorOf" stringByAppendingString:capitalizedKey]) ofClass:cls] != _objc_msgForward;
+            BOOL member = [self dependOnSelector:NSSelectorFromString([NSString stringWithFormat:@"memberOf%@:", capitalizedKey]) ofClass:cls] != _objc_msgForward;
+            
+            foundGetter = count && (objectAtIndex || objectsAtIndexes || (enumerator && member));
+            
+        }
+        
+        if (!foundGetter && accessIvars) {
+            
+            _getterIvar = [self ivarForClass:cls capitalizedKey:capitalizedKey type:&_getterType];
+            
+        }
+        
+        // Setter: -setKey:, -_setKey:, then _key, _isKey, key, isKey
+        for (NSString *name in @[[NSString stringWithFormat:@"set%@:", capitalizedKey], [NSString stringWithFormat:@"_set%@:", capitalizedKey]]) {
+            
+            SEL selector = NSSelectorFromString(name);
+            [self dependOnSelector:selector ofClass:cls];
+            Method method = class_getInstanceMethod(cls, selector);
+            
+            if (!method || method_getNumberOfArguments(method) != 3)
+                continue;
+            
+            char *argumentType = method_copyArgumentType(method, 2);
+            _setterType = SQScalarTypeFromEncoding(argumentType);
+            free(argumentType);
+            
+            if (_setterType) {
+                
+                _setter = selector;
+                _setterIMP = method_getImplementation(method);
+                
+            }
+            
+            foundSetter = YES;
+            break;
+            
+        }
+        
+        // Writing an ivar directly bypasses the automatic change notifications standard KVC sends, so never do it on a class that overrides -class (i.e. a KVO subclass)
+        BOOL observable = [self dependOnSelector:@selector(class) ofClass:cls] != [NSObject instanceMethodForSelector:@selector(class)];
+        
+        if (!foundSetter && accessIvars && !observable) {
+            
+            _setterIvar = [self ivarForClass:cls capitalizedKey:capitalizedKey type:&_setterType];
+            
+        }
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Public Instance Methods
+
+- (id)valueForObject:(id)object {
+    
+    if (!_getterIMP && !_getterIvar)
+        return [object valueForKey:_key];
+    
+    switch (_getterType) {
+        
+        case '@':
+            return _getterIMP ? ((id (*)(id, SEL))_getterIMP)(object, _getter) : object_getIvar(object, _getterIvar);
+        case 'c':
+            return @(SQGetScalar(object, char));
+        case 'C':
+            return @(SQGetScalar(object, unsigned char));
+        case 's':
+            return @(SQGetScalar(object, short));
+        case 'S':
+            return @(SQGetScalar(object, unsigned short));
+        case 'i':
+            return @(SQGetScalar(object, int));
+        case 'I':
+            return @(SQGetScalar(object, unsigned int));
+        case 'l':
+            return @(SQGetScalar(object, long));
+        case 'L':
+            return @(SQGetScalar(object, unsigned long));
+        case 'q':
+            return @(SQGetScalar(object, long long));
+        case 'Q':
+            return @(SQGetScalar(object, unsigned long long));
+        case 'f':
+            return @(SQGetScalar(object, float));
+        case 'd':
+            return @(SQGetScalar(object, double));
+        case 'B':
+            return @(SQGetScalar(object, bool));
+        default:
+            return [object valueForKey:_key];
+        
+    }
+    
+}
+
+- (void)setValue:(id)value forObject:(id)object {
+    
+    if ((!_setterIMP && !_setterIvar) || (!value && _setterType != '@')) {
+        
+        [object setValue:value forKey:_key];
+        return;
+        
+    }
+    
+    switch (_setterType) {
+        
+        case '@':
+            if (_setterIMP)
+                ((void (*)(id, SEL, id))_setterIMP)(object, _setter, value);
+            else
+                object_setIvarWithStrongDefault(object, _setterIvar, value);
+            break;
+        case 'c':
+            SQSetScalar(object, char, [value charValue]);
+            break;
+        case 'C':
+            SQSetScalar(object, unsigned char, [value unsignedCharValue]);
+            break;
+        case 's':
+            SQSetScalar(object, short, [value shortValue]);
+            break;
+        case 'S':
+            SQSetScalar(object, unsigned short, [value unsignedShortValue]);
+            break;
+        case 'i':
+            SQSetScalar(object, int, [value intValue]);
+            break;
+        case 'I':
+            SQSetScalar(object, unsigned int, [value unsignedIntValue]);
+            break;
+        case 'l':
+            SQSetScalar(object, long, [value longValue]);
+            break;
+        case 'L':
+            SQSetScalar(object, unsigned long, [value unsignedLongValue]);
+            break;
+        case 'q':
+            SQSetScalar(object, long long, [value longLongValue]);
+            break;
+        case 'Q':
+            SQSetScalar(object, unsigned long long, [value unsignedLongLongValue]);
+            break;
+        case 'f':
+            SQSetScalar(object, float, [value floatValue]);
+            break;
+        case 'd':
+            SQSetScalar(object, double, [value doubleValue]);
+            break;
+        case 'B':
+            SQSetScalar(object, bool, [value boolValue]);
+            break;
+        default:
+            [object setValue:value forKey:_key];
+            break;
+        
+    }
+    
+}
+
+- (int64_t)int64ValueForObject:(id)object {
+    
+    if (!_getterIMP && !_getterIvar)
+        return [[object valueForKey:_key] longLongValue];
+    
+    switch (_getterType) {
+        
+        case '@':
+            return [[self valueForObject:object] longLongValue];
+        case 'c':
+            return SQGetScalar(object, char);
+        case 'C':
+            return SQGetScalar(object, unsigned char);
+        case 's':
+            return SQGetScalar(object, short);
+        case 'S':
+            return SQGetScalar(object, unsigned short);
+        case 'i':
+            return SQGetScalar(object, int);
+        case 'I':
+            return SQGetScalar(object, unsigned int);
+        case 'l':
+            return SQGetScalar(object, long);
+        case 'L':
+            return (int64_t)SQGetScalar(object, unsigned long);
+        case 'q':
+            return SQGetScalar(object, long long);
+        case 'Q':
+            return (int64_t)SQGetScalar(object, unsigned long long);
+        case 'f':
+            return (int64_t)SQGetScalar(object, float);
+        case 'd':
+            return (int64_t)SQGetScalar(object, double);
+        case 'B':
+            return SQGetScalar(object, bool);
+        default:
+            return [[object valueForKey:_key] longLongValue];
+        
+    }
+    
+}
+
+- (double)doubleValueForObject:(id)object {
+    
+    if (!_getterIMP && !_getterIvar)
+        return [[object valueForKey:_key] doubleValue];
+    
+    switch (_getterType) {
+        
+        case '@':
+            return [[self valueForObject:object] doubleValue];
+        case 'c':
+            return SQGetScalar(object, char);
+        case 'C':
+            return SQGetScalar(object, unsigned char);
+        case 's':
+            return SQGetScalar(object, short);
+        case 'S':
+            return SQGetScalar(object, unsigned short);
+        case 'i':
+            return SQGetScalar(object, int);
+        case 'I':
+            return SQGetScalar(object, unsigned int);
+        case 'l':
+            return SQGetScalar(object, long);
+        case 'L':
+            return SQGetScalar(object, unsigned long);
+        case 'q':
+            return SQGetScalar(object, long long);
+        case 'Q':
+            return SQGetScalar(object, unsigned long long);
+        case 'f':
+            return SQGetScalar(object, float);
+        case 'd':
+            return SQGetScalar(object, double);
+        case 'B':
+            return SQGetScalar(object, bool);
+        default:
+            return [[object valueForKey:_key] doubleValue];
+        
+    }
+    
+}
+
+#pragma mark - Private Instance Methods
+
+/**
+ Look up a selector's implementation, and remember it, so the accessor can tell later if it changed
+ 
+ @param selector The selector
+ @param cls The class
+ @return The implementation, or _objc_msgForward if the class doesn't respond to the selector
+ */
+- (IMP)dependOnSelector:(SEL)selector ofClass:(Class)cls {
+    
+    IMP imp = class_getMethodImplementation(cls, selector);
+    
+    if (_dependencyCount < SQKeyValueAccessorMaxDependencies) {
+        
+        _dependencies[_dependencyCount] = selector;
+        _dependencyIMPs[_dependencyCount] = imp;
+        _dependencyCount++;
+        
+    }
+    
+    return imp;
+    
+}
+
+/**
+ Check that everything the accessor was resolved from is still the same on a class
+ 
+ @param cls The class
+ @return YES if the accessor is still right for the class
+ */
+- (BOOL)isCurrentForClass:(Class)cls {
+    
+    for (NSUInteger i = 0; i < _dependencyCount; i++) {
+        
+        if (class_getMethodImplementation(cls, _dependencies[i]) != _dependencyIMPs[i])
+            return NO;
+        
+    }
+    
+    if (_getterIvar && class_getInstanceVariable(cls, ivar_getName(_getterIvar)) != _getterIvar)
+        return NO;
+    
+    if (_setterIvar && class_getInstanceVariable(cls, ivar_getName(_setterIvar)) != _setterIvar)
+        return NO;
+    
+    return YES;
+    
+}
+
+- (Ivar)ivarForClass:(Class)cls capitalizedKey:(NSString *)capitalizedKey type:(char *)type {
+    
+    for (NSString *name in @[[@"_" stringByAppendingString:_key], [@"_is" stringByAppendingString:capitalizedKey], _key, [@"is" stringByAppendingString:capitalizedKey]]) {
+        
+        Ivar ivar = class_getInstanceVariable(cls, name.UTF8String);
+        
+        if (!ivar)
+            continue;
+        
+        *type = SQScalarTypeFromEncoding(ivar_getTypeEncoding(ivar));
+        
+        return *type ? ivar : NULL;
+        
+    }
+    
+    return NULL;
+    
+}
+
+@end
+
+#pragma mark - Bulk Access
+
+NSArray *SQValuesForKey(id<NSFastEnumeration> objects, NSUInteger count, NSString *key) {
+    
+    NSMutableArray *values = [NSMutableArray arrayWithCapacity:count];
+    Class lastClass = Nil;
+    SQKeyValueAccessor *accessor = nil;
+    
+    for (id object in objects) {
+        
+        Class cls = object_getClass(object);
+        
+        if (cls != lastClass) {
+            
+            lastClass = cls;
+            accessor = [SQKeyValueAccessor accessorForClass:cls key:key];
+            
+        }
+        
+        id value = accessor ? [accessor valueForObject:object] : [object valueForKey:key];
+        [values addObject:value ?: [NSNull null]];
+        
+    }
+    
+    return values;
+    
+}
+
+void SQSetValueForKey(id<NSFastEnumeration> objects, id value, NSString *key) {
+    
+    Class lastClass = Nil;
+    SQKeyValueAccessor *accessor = nil;
+    
+    for (id object in objects) {
+        
+        Class cls = object_getClass(object);
+        
+        if (cls != lastClass) {
+            
+            lastClass = cls;
+            accessor = [SQKeyValueAccessor accessorForClass:cls key:key];
+            
+        }
+        
+        if (accessor)
+            [accessor setValue:value forObject:object];
+        else
+            [object setValue:value forKey:key];
+        
+    }
+    
+}
+
+void SQInt64ValuesForKey(id<NSFastEnumeration> objects, NSString *key, int64_t *buffer) {
+    
+    Class lastClass = Nil;
+    SQKeyValueAccessor *accessor = nil;
+    
+    for (id object in objects) {
+        
+        Class cls = object_getClass(object);
+        
+        if (cls != lastClass) {
+            
+            lastClass = cls;
+            accessor = [SQKeyValueAccessor accessorForClass:cls key:key];
+            
+        }
+        
+        *buffer++ = accessor ? [accessor int64ValueForObject:object] : [[object valueForKey:key] longLongValue];
+        
+    }
+    
+}
+
+void SQDoubleValuesForKey(id<NSFastEnumeration> objects, NSString *key, double *buffer) {
+    
+    Class lastClass = Nil;
+    SQKeyValueAccessor *accessor = nil;
+    
+    for (id object in objects) {
+        
+        Class cls = object_getClass(object);
+        
+        if (cls != lastClass) {
+            
+            lastClass = cls;
+            accessor = [SQKeyValueAccessor accessorForClass:cls key:key];
+            
+        }
+        
+        *buffer++ = accessor ? [accessor doubleValueForObject:object] : [[object valueForKey:key] doubleValue];
+        
+    }
+    
+}
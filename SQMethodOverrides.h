@@ -0,0 +1,25 @@
+//
+//  SQMethodOverrides.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Find which of a base class's methods a class inherits without overriding, so direct C paths can stand in for them
+
+ @discussion The mask reflects the class's methods at the time of the call, so a class swizzled afterwards isn't noticed by callers that keep it. Each selector costs two method lookups, which hit the runtime's method cache, so this is cheap enough to call from an initializer.
+ @param cls The class, as returned by object_getClass()
+ @param base The base class that defines the methods
+ @param selectors The selectors, at most 32
+ @param count The number of selectors
+ @return A mask with bit i set if `cls` uses the base class's implementation of `selectors[i]`
+ */
+FOUNDATION_EXTERN uint32_t SQInheritedMethodMask(Class cls, Class base, const SEL _Nonnull * _Nonnull selectors, NSUInteger count);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,32 @@
+//
+//  SQMethodOverrides.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "SQMethodOverrides.h"
+
+#import <objc/runtime.h>
+
+uint32_t SQInheritedMethodMask(Class cls, Class base, const SEL *selectors, NSUInteger count) {
+    
+    uint32_t all = count >= 32 ? UINT32_MAX : ((uint32_t)1 << count) - 1;
+    
+    if (cls == base)
+        return all;
+    
+    // Not cached: checking a cached mask against swizzling or a reused class address would take the same lookups as computing it, and those hit the runtime's method cache.
+    uint32_t mask = 0;
+    
+    for (NSUInteger i = 0; i < MIN(count, 32); i++) {
+        
+        if (class_getMethodImplementation(cls, selectors[i]) == class_getMethodImplementation(base, selectors[i]))
+            mask |= (uint32_t)1 << i;
+        
+    }
+    
+    return mask;
+    
+}
@@ -0,0 +1,138 @@
+//
+//  ShardedQueue.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+#import "Queueing.h"
+
+/**
+ The ordering guarantees a sharded queue makes
+ */
+typedef NS_ENUM(NSUInteger, ShardedQueueOrdering) {
+    
+    /**
+     Objects enqueued by the same thread are dequeued in the order they were enqueued. Every thread always enqueues to its own lane.
+     */
+    ShardedQueueOrderingPerProducerFIFO,
+    
+    /**
+     No ordering guarantee. Producers that find their own lane busy enqueue to the next free lane instead of waiting.
+     */
+    ShardedQueueOrderingRelaxed
+    
+};
+
+/**
+ A thread-safe, multi-lane Queue in Objective-C, for hosts with many cores
+ 
+ @discussion Every thread is assigned a home lane. Enqueues go to the home lane, and dequeues prefer it, stealing from the other lanes only when it's empty, so threads mostly touch cache lines nobody else is using. The trade-off is relaxed FIFO: objects are only ordered within a lane.
+ */
+@interface ShardedQueue<__covariant ObjectType> : NSObject<Queueing>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @name Factory Methods
+ */
+
+/**
+ Create an empty queue, with one lane per active processor and per-producer FIFO ordering
+ 
+ @return The queue
+ */
++ (instancetype)queue;
+
+/**
+ Create an empty queue
+ 
+ @param laneCount The number of lanes
+ @param ordering The ordering guarantee
+ @return The queue
+ */
++ (instancetype)queueWithLaneCount:(NSUInteger)laneCount ordering:(ShardedQueueOrdering)ordering;
+
+/**
+ @name Initializers
+ */
+
+/**
+ Create an empty queue
+ 
+ @param laneCount The number of lanes. Must be at least 1.
+ @param ordering The ordering guarantee
+ @return The queue
+ */
+- (instancetype)initWithLaneCount:(NSUInteger)laneCount ordering:(ShardedQueueOrdering)ordering NS_DESIGNATED_INITIALIZER;
+
+/**
+ @name Enqueue, Peek, Dequeue
+ */
+
+/**
+ Enqueue an object on the calling thread's lane. Safe to call from any thread.
+ 
+ @param object The object
+ */
+- (void)enqueue:(ObjectType)object;
+
+/**
+ Enqueue an array of objects, in order, on the calling thread's lane. Safe to call from any thread.
+ 
+ @param objects The array
+ */
+- (void)enqueueObjects:(NSArray<ObjectType> *)objects;
+
+/**
+ View the item at the front of the calling thread's lane, or of the first non-empty lane after it, which is the item -dequeue would take if nothing changed in between. Safe to call from any thread.
+ 
+ @discussion This is best effort: lanes are checked one at a time, so with other threads running, the item may be dequeued by someone else at any time, and an item enqueued to a lane that was already checked is missed.
+ @return The item, or nil if every lane was empty when it was checked
+ */
+- (nullable ObjectType)peek;
+
+/**
+ Dequeue an item from the calling thread's lane, or steal one from another lane if it's empty. Safe to call from any thread.
+ 
+ @return The item, or nil if every lane is empty
+ */
+- (nullable ObjectType)dequeue;
+
+/**
+ @name Content Checking & Statistics
+ */
+
+/**
+ The number of items in the queue, summed over every lane
+ 
+ @note With producers and consumers running, this is only a snapshot
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+/**
+ The number of lanes
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger laneCount;
+
+/**
+ The ordering guarantee
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) ShardedQueueOrdering ordering;
+
+/**
+ The number of items in each lane
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSArray<NSNumber *> *laneDepths;
+
+/**
+ The number of items each lane has had stolen by threads from other lanes
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSArray<NSNumber *> *laneSteals;
+
+NS_ASSUME_NONNULL_END
+
+@end
@@ -0,0 +1,300 @@
+//
+//  ShardedQueue.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ShardedQueue.h"
+#import "SQChunkedBuffer.h"
+
+#import <os/lock.h>
+#import <stdatomic.h>
+
+#define SQCacheLineSize 128
+
+/**
+ A single lane, padded out to its own cache lines
+ */
+typedef struct __attribute__((aligned(SQCacheLineSize))) SQShardedQueueLane {
+    
+    os_unfair_lock lock;
+    SQChunkedBuffer buffer;
+    _Atomic(NSUInteger) depth;
+    _Atomic(NSUInteger) steals;
+    
+} SQShardedQueueLane;
+
+static _Atomic(NSUInteger) SQShardedQueueNextThreadSlot = 0;
+static _Thread_local NSUInteger SQShardedQueueThreadSlot = 0;
+
+/**
+ A small, stable number for the calling thread, handed out round-robin the first time each thread asks
+ 
+ @return The thread's slot
+ */
+NS_INLINE NSUInteger SQShardedQueueCurrentThreadSlot(void) {
+    
+    if (SQShardedQueueThreadSlot == 0) {
+        
+        SQShardedQueueThreadSlot = atomic_fetch_add_explicit(&SQShardedQueueNextThreadSlot, 1, memory_order_relaxed) + 1;
+        
+    }
+    
+    return SQShardedQueueThreadSlot - 1;
+    
+}
+
+@implementation ShardedQueue {
+    
+    SQShardedQueueLane *_lanes;
+    
+}
+
+#pragma mark - Public Class Methods
+
++ (instancetype)queue {
+    
+    return [[self alloc] init];
+    
+}
+
++ (instancetype)queueWithLaneCount:(NSUInteger)laneCount ordering:(ShardedQueueOrdering)ordering {
+    
+    return [[self alloc] initWithLaneCount:laneCount ordering:ordering];
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (instancetype)init {
+    
+    self = [self initWithLaneCount:[NSProcessInfo processInfo].activeProcessorCount
+                          ordering:ShardedQueueOrderingPerProducerFIFO];
+    
+    return self;
+    
+}
+
+- (void)dealloc {
+    
+    for (NSUInteger i = 0; i < _laneCount; i++) {
+        
+        SQChunkedBufferDestroy(&_lanes[i].buffer);
+        
+    }
+    
+    free(_lanes);
+    
+}
+
+- (NSString *)description {
+    
+    return [NSString stringWithFormat:@"<%@: %p; lanes = %@>", NSStringFromClass([self class]), self, self.laneDepths];
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (NSUInteger)count {
+    
+    NSUInteger count = 0;
+    
+    for (NSUInteger i = 0; i < _laneCount; i++) {
+        
+        count += atomic_load_explicit(&_lanes[i].depth, memory_order_relaxed);
+        
+    }
+    
+    return count;
+    
+}
+
+- (NSArray<NSNumber *> *)laneDepths {
+    
+    NSMutableArray<NSNumber *> *depths = [NSMutableArray arrayWithCapacity:_laneCount];
+    
+    for (NSUInteger i = 0; i < _laneCount; i++) {
+        
+        [depths addObject:@(atomic_load_explicit(&_lanes[i].depth, memory_order_relaxed))];
+        
+    }
+    
+    return depths;
+    
+}
+
+- (NSArray<NSNumber *> *)laneSteals {
+    
+    NSMutableArray<NSNumber *> *steals = [NSMutableArray arrayWithCapacity:_laneCount];
+    
+    for (NSUInteger i = 0; i < _laneCount; i++) {
+        
+        [steals addObject:@(atomic_load_explicit(&_lanes[i].steals, memory_order_relaxed))];
+        
+    }
+    
+    return steals;
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithLaneCount:(NSUInteger)laneCount ordering:(ShardedQueueOrdering)ordering {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        NSUInteger count = MAX(1, laneCount);
+        SQShardedQueueLane *lanes = NULL;
+        
+        // Only publish the lanes once they exist, so -dealloc has nothing to tear down if this fails
+        if (posix_memalign((void **)&lanes, SQCacheLineSize, count * sizeof(SQShardedQueueLane)) != 0) {
+            
+            return nil;
+            
+        }
+        
+        _lanes = lanes;
+        _laneCount = count;
+        _ordering = ordering;
+        
+        for (NSUInteger i = 0; i < _laneCount; i++) {
+            
+            _lanes[i].lock = OS_UNFAIR_LOCK_INIT;
+            SQChunkedBufferInit(&_lanes[i].buffer);
+            atomic_init(&_lanes[i].depth, 0);
+            atomic_init(&_lanes[i].steals, 0);
+            
+        }
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Enqueue Dequeue
+
+- (void)enqueue:(id)object {
+    
+    SQShardedQueueLane *lane = [self lockLaneForEnqueueing];
+    SQChunkedBufferAppend(&lane->buffer, object);
+    atomic_fetch_add_explicit(&lane->depth, 1, memory_order_relaxed);
+    os_unfair_lock_unlock(&lane->lock);
+    
+}
+
+- (void)enqueueObjects:(NSArray *)objects {
+    
+    if (objects.count == 0)
+        return;
+    
+    SQShardedQueueLane *lane = [self lockLaneForEnqueueing];
+    SQChunkedBufferAppendObjects(&lane->buffer, objects);
+    atomic_fetch_add_explicit(&lane->depth, objects.count, memory_order_relaxed);
+    os_unfair_lock_unlock(&lane->lock);
+    
+}
+
+- (id)peek {
+    
+    NSUInteger home = SQShardedQueueCurrentThreadSlot() % _laneCount;
+    
+    // Lanes are visited in the same order as -dequeue, so this is what it would take next
+    for (NSUInteger i = 0; i < _laneCount; i++) {
+        
+        SQShardedQueueLane *lane = &_lanes[(home + i) % _laneCount];
+        
+        if (atomic_load_explicit(&lane->depth, memory_order_relaxed) == 0)
+            continue;
+        
+        os_unfair_lock_lock(&lane->lock);
+        id object = lane->buffer.count > 0 ? SQChunkedBufferObjectAtIndex(&lane->buffer, 0) : nil;
+        os_unfair_lock_unlock(&lane->lock);
+        
+        if (object)
+            return object;
+        
+    }
+    
+    return nil;
+    
+}
+
+- (id)dequeue {
+    
+    NSUInteger home = SQShardedQueueCurrentThreadSlot() % _laneCount;
+    
+    for (NSUInteger i = 0; i < _laneCount; i++) {
+        
+        SQShardedQueueLane *lane = &_lanes[(home + i) % _laneCount];
+        
+        // Don't bother taking the lock on a lane that looks empty
+        if (atomic_load_explicit(&lane->depth, memory_order_relaxed) == 0)
+            continue;
+        
+        os_unfair_lock_lock(&lane->lock);
+        
+        id object = SQChunkedBufferRemoveFirst(&lane->buffer);
+        
+        if (object) {
+            
+            atomic_fetch_sub_explicit(&lane->depth, 1, memory_order_relaxed);
+            
+        }
+        
+        os_unfair_lock_unlock(&lane->lock);
+        
+        if (object) {
+            
+            if (i > 0) {
+                
+                atomic_fetch_add_explicit(&lane->steals, 1, memory_order_relaxed);
+                
+            }
+            
+            return object;
+            
+        }
+        
+    }
+    
+    return nil;
+    
+}
+
+#pragma mark - Private Instance Methods
+
+/**
+ Pick and lock the lane the calling thread should enqueue to
+ 
+ @return The lane, locked
+ */
+- (SQShardedQueueLane *)lockLaneForEnqueueing {
+    
+    NSUInteger home = SQShardedQueueCurrentThreadSlot() % _laneCount;
+    
+    if (_ordering == ShardedQueueOrderingRelaxed) {
+        
+        for (NSUInteger i = 0; i < _laneCount; i++) {
+            
+            SQShardedQueueLane *lane = &_lanes[(home + i) % _laneCount];
+            
+            if (os_unfair_lock_trylock(&lane->lock))
+                return lane;
+            
+        }
+        
+    }
+    
+    SQShardedQueueLane *lane = &_lanes[home];
+    os_unfair_lock_lock(&lane->lock);
+    
+    return lane;
+    
+}
+
+@end
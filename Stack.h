@@ -8,10 +8,47 @@
 
 @import Foundation;
 
+#import "StackQueueChange.h"
+#import "SQBinaryCodec.h"
+#import "SQContiguousBuffer.h"
+
+#ifndef SQStackInlineCapacity
+/**
+ The number of objects every stack stores inside the instance itself, unless it's allocated with +allocWithInlineCapacity:. Define it in the build settings to give every stack inline storage.
+ */
+#define SQStackInlineCapacity 0
+#endif
+
+/**
+ The operations the inline stack functions may perform directly on an instance
+ */
+typedef NS_OPTIONS(uint32_t, SQStackFastPath) {
+
+    SQStackFastPathPush = 1 << 0,
+    SQStackFastPathPop = 1 << 1,
+    SQStackFastPathPeek = 1 << 2,
+    SQStackFastPathCount = 1 << 3
+
+};
+
 /**
- A LIFO Stack implemented in Objective-C, backed by an NSArray
+ A LIFO Stack implemented in Objective-C, backed by a contiguous C array
  */
-@interface Stack<__covariant ObjectType> : NSObject<NSSecureCoding, NSCopying, NSFastEnumeration>
+@interface Stack<__covariant ObjectType> : NSObject<NSSecureCoding, NSCopying, NSFastEnumeration> {
+
+    @public
+
+    /**
+     Private. The stack's storage, exposed only for the inline functions below.
+     */
+    SQContiguousBuffer _buffer;
+
+    /**
+     Private. The SQStackFastPath operations the inline functions may perform directly. An operation is excluded while the class overrides its method, or while change observers or marks need to see it.
+     */
+    uint32_t _fastPaths;
+
+}
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -59,6 +96,22 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (nullable instancetype)stackWithArray:(NSArray<ObjectType> *)array;
 
+/**
+ Create an empty stack that stores up to a number of objects inside the instance itself, and only allocates storage once it holds more than that
+ 
+ @param capacity The number of objects to store inline
+ @return The stack
+ */
++ (nullable instancetype)stackWithInlineCapacity:(NSUInteger)capacity;
+
+/**
+ Allocate a stack with room for a number of objects inside the instance itself, to be initialized with any initializer. Stacks allocated with +alloc get SQStackInlineCapacity objects of inline storage.
+ 
+ @param capacity The number of objects to store inline
+ @return The uninitialized stack
+ */
++ (instancetype)allocWithInlineCapacity:(NSUInteger)capacity;
+
 /**
  @name Initializers
  */
@@ -88,6 +141,26 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable instancetype)initWithObjects:(ObjectType const *)objects count:(NSUInteger)cnt;
 
+/**
+ Create a stack that takes over a C array of objects, without copying it
+
+ @discussion The stack adopts both the storage and the reference it holds to each object, so the objects must be retained (as they are in a `__strong id *` buffer) and the caller must not release them or use the buffer afterwards.
+ @param objects The C array
+ @param cnt The length of the C array
+ @param freeWhenDone YES if the C array was allocated with malloc and the stack should free it, NO if the caller keeps the memory alive for the lifetime of the stack
+ @return The stack
+ */
+- (nullable instancetype)initWithObjectsNoCopy:(__strong ObjectType *)objects count:(NSUInteger)cnt freeWhenDone:(BOOL)freeWhenDone;
+
+/**
+ Create a stack with the contents of a mutable array, and empty the array
+
+ @discussion This is a move, not a no-copy adoption: the objects are copied into the stack's own storage in a single bulk O(n) pass, and then removed from the array. To take over storage without copying it, use -initWithObjectsNoCopy:count:freeWhenDone:.
+ @param array The mutable array
+ @return The stack
+ */
+- (nullable instancetype)initByMovingObjectsFromArray:(NSMutableArray<ObjectType> *)array;
+
 /**
  Create a stack with an NSArray
 
@@ -117,17 +190,43 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  View the item at the top of the stack
 
- @return The item at the top of the stack
+ @return The item at the top of the stack, or nil if the stack is empty
  */
 - (nullable ObjectType)peek;
 
 /**
  Remove the item from the top of the stack and return it
 
- @return The item formerly at the top of the stack
+ @return The item formerly at the top of the stack, or nil if the stack is empty
  */
 - (nullable ObjectType)pop;
 
+/**
+ @name Marks
+ */
+
+/**
+ Mark the current top of the stack, to roll back to or commit later, in O(1)
+
+ @discussion Marks replace copying the stack to save state for backtracking. Marks nest: rolling back to or committing a mark also discards every mark pushed after it. Popping below a mark moves the mark down with it.
+ @return An opaque token for the mark
+ */
+- (id<NSObject>)pushMark;
+
+/**
+ Pop everything pushed since a mark in one pass, and discard the mark, in O(k) for k objects above it
+
+ @param mark A mark returned by -pushMark that hasn't been rolled back, committed, or discarded by an outer mark
+ */
+- (void)rollbackToMark:(id<NSObject>)mark;
+
+/**
+ Discard a mark, keeping everything pushed since it
+
+ @param mark A mark returned by -pushMark that hasn't been rolled back, committed, or discarded by an outer mark
+ */
+- (void)commitMark:(id<NSObject>)mark;
+
 /**
  @name Equality & Content Checking
  */
@@ -350,6 +449,35 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSEnumerator *)objectEnumerator;
 
+/**
+ @name Removing Objects
+ */
+
+/**
+ Remove every object that passes a test, closing up the rest in place in a single pass
+
+ @discussion Every object is tested before anything is removed, so the test sees the stack as it was. The test must not mutate the stack: if it does, an NSGenericException is raised and nothing is removed. The results take a byte per object, in storage the stack keeps between calls, so purging a stack regularly doesn't allocate once that storage is big enough. Live marks move down past the objects removed beneath them, so rolling back still removes exactly what was pushed after the mark.
+ @param predicate The test to apply to each object
+ @return The number of objects removed
+ */
+- (NSUInteger)removeObjectsPassingTest:(BOOL (^)(ObjectType obj, NSUInteger idx, BOOL *stop))predicate;
+
+/**
+ Remove every object that passes a test, closing up the rest in place
+
+ @param opts NSEnumerationConcurrent evaluates an expensive test for every object in parallel before the stack is compacted. Setting stop is then best-effort: objects that other threads had already tested may still be removed. Other options are ignored.
+ @param predicate The test to apply to each object. With NSEnumerationConcurrent it must be safe to call from any thread.
+ @return The number of objects removed
+ */
+- (NSUInteger)removeObjectsWithOptions:(NSEnumerationOptions)opts passingTest:(BOOL (^)(ObjectType obj, NSUInteger idx, BOOL *stop))predicate;
+
+/**
+ Keep only the objects that match a predicate, in place
+
+ @param predicate The predicate
+ */
+- (void)filterUsingPredicate:(NSPredicate *)predicate;
+
 /**
  @name Deriving Stacks
  */
@@ -511,6 +639,74 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSString *)componentsJoinedByString:(NSString *)separator;
 
+/**
+ @name Binary Coding
+ */
+
+/**
+ Write the stack to a stream in a compact, length-prefixed binary format, much faster and smaller than keyed archiving
+
+ @discussion Strings, numbers and data objects are written directly. Any other object is archived with secure coding, and must support it. Objects are written bottom to top, through a fixed-size buffer.
+ @param stream The stream. It is opened if it isn't already, and left open.
+ @param error The error, if the stream failed or an object couldn't be encoded
+ @return YES if the stack was written, otherwise NO.
+ */
+- (BOOL)writeToStream:(NSOutputStream *)stream error:(NSError **)error;
+
+/**
+ Push objects read from a stream written by -writeToStream:error:, as they're read
+
+ @discussion The stream is read through a fixed-size buffer and objects are pushed in batches as they're decoded, so even very large dumps load in bounded memory beyond the objects themselves. If decoding fails part way, the objects read before the failure stay pushed.
+ @param stream The stream. It is opened if it isn't already, and left open.
+ @param allowedClasses The classes archived objects may decode as. Strings, numbers and data objects are always allowed.
+ @param error The error, if the stream failed or didn't hold valid data
+ @return YES if the whole stream was read, otherwise NO.
+ */
+- (BOOL)pushObjectsFromStream:(NSInputStream *)stream allowedClasses:(NSSet<Class> *)allowedClasses error:(NSError **)error;
+
+/**
+ @name Key-Value Coding
+ */
+
+/**
+ Extract the value for a key from every object in the stack into a buffer of 64-bit integers, without boxing
+
+ @discussion The getter (or instance variable) for the key is resolved once per class and reused for every object of that class. Scalar properties are read directly; object properties are converted with -longLongValue; nil values become 0.
+ @param key The key
+ @param buffer The buffer, which must have room for `count` values
+ */
+- (void)int64ValuesForKey:(NSString *)key into:(int64_t *)buffer;
+
+/**
+ Extract the value for a key from every object in the stack into a buffer of doubles, without boxing
+
+ @discussion The getter (or instance variable) for the key is resolved once per class and reused for every object of that class. Scalar properties are read directly; object properties are converted with -doubleValue; nil values become 0.
+ @param key The key
+ @param buffer The buffer, which must have room for `count` values
+ */
+- (void)doubleValuesForKey:(NSString *)key into:(double *)buffer;
+
+/**
+ @name Observing Changes
+ */
+
+/**
+ Observe changes to the stack itself, as coalesced batches of change records
+
+ @discussion Stacks are not KVO compliant. Instead, every mutation is recorded and coalesced until `queue` drains, then delivered as a single batch: ten thousand objects pushed before the block runs arrive as one insertion. Each record in a batch is expressed in terms of the contents after the records before it have been applied.
+ @param queue The dispatch queue to deliver changes on. Changes are coalesced per drain of this queue, so use the main queue to coalesce per run loop turn.
+ @param block The block to deliver changes to
+ @return An opaque observer, to pass to -removeChangeObserver:
+ */
+- (id<NSObject>)addChangeObserverOnQueue:(dispatch_queue_t)queue usingBlock:(void (^)(NSArray<StackQueueChange *> *changes))block;
+
+/**
+ Stop observing changes to the stack. Changes that have been recorded but not yet delivered are discarded.
+
+ @param observer The observer returned by -addChangeObserverOnQueue:usingBlock:
+ */
+- (void)removeChangeObserver:(id<NSObject>)observer;
+
 /**
  @name Key-Value Observation
  */
@@ -538,3 +734,71 @@ NS_ASSUME_NONNULL_BEGIN
 NS_ASSUME_NONNULL_END
 
 @end
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @name Inline Functions
+ */
+
+/**
+ Push an object, without a message send when the stack allows it. Equivalent to -push:.
+
+ @param stack The stack
+ @param object The object
+ */
+NS_INLINE void SQStackPush(Stack *stack, id object) {
+
+    if (stack->_fastPaths & SQStackFastPathPush)
+        SQContiguousBufferAppend(&stack->_buffer, object);
+    else
+        [stack push:object];
+
+}
+
+/**
+ Pop an object, without a message send when the stack allows it. Equivalent to -pop.
+
+ @param stack The stack
+ @return The item formerly at the top of the stack
+ */
+NS_INLINE id _Nullable SQStackPop(Stack *stack) {
+
+    if (stack->_fastPaths & SQStackFastPathPop)
+        return SQContiguousBufferRemoveLast(&stack->_buffer);
+
+    return [stack pop];
+
+}
+
+/**
+ View the item at the top of the stack, without a message send when the stack allows it. Equivalent to -peek.
+
+ @param stack The stack
+ @return The item at the top of the stack
+ */
+NS_INLINE id _Nullable SQStackPeek(Stack *stack) {
+
+    if (stack->_fastPaths & SQStackFastPathPeek)
+        return stack->_buffer.count > 0 ? (__bridge id)stack->_buffer.objects[stack->_buffer.count - 1] : nil;
+
+    return [stack peek];
+
+}
+
+/**
+ The number of items in the stack, without a message send when the stack allows it. Equivalent to -count.
+
+ @param stack The stack
+ @return The number of items
+ */
+NS_INLINE NSUInteger SQStackCount(Stack *stack) {
+
+    if (stack->_fastPaths & SQStackFastPathCount)
+        return stack->_buffer.count;
+
+    return stack.count;
+
+}
+
+NS_ASSUME_NONNULL_END
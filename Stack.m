@@ -7,6 +7,12 @@
 //
 
 #import "Stack.h"
+#import "SQKeyValueAccessor.h"
+#import "SQChangeObserver.h"
+#import "SQMethodOverrides.h"
+#import "SQConcurrentTest.h"
+
+#import <objc/runtime.h>
 
 @interface StackEnumerator : NSEnumerator {
     
@@ -46,9 +52,160 @@
 
 @end
 
-@interface Stack<ObjectType> ()
+/**
+ A live mark, in the stack's list of nested marks
+ */
+typedef struct SQStackMarkRecord {
+    
+    // The count when the mark was pushed
+    NSUInteger depth;
+    
+    // The lowest count since the mark was pushed, while it was the innermost mark
+    NSUInteger low;
+    
+    NSUInteger generation;
+    
+} SQStackMarkRecord;
+
+/**
+ Where a position in the stack ends up after a range beneath it is removed
+ 
+ @param position The position
+ @param range The removed range
+ @return The new position
+ */
+NS_INLINE NSUInteger SQStackPositionAfterRemoval(NSUInteger position, NSRange range) {
+    
+    if (position <= range.location)
+        return position;
+    
+    return position >= NSMaxRange(range) ? position - range.length : range.location;
+    
+}
+
+/**
+ The token handed out for a mark, which identifies its record by position and generation
+ */
+@interface SQStackMark : NSObject {
+    
+    @public
+    __weak Stack *_stack;
+    NSUInteger _level;
+    NSUInteger _generation;
+    
+}
+
+@end
+
+@implementation SQStackMark
+
+@end
+
+/**
+ A read-only NSArray over a stack's buffer, so the NSArray algorithms can run on the stack without copying it first. It reads the stack live, and raises if the stack is mutated while it's still being read.
+ */
+@interface StackArrayView : NSArray {
+    
+    Stack *_stack;
+    unsigned long _mutations;
+    
+}
+
+- (instancetype)initWithStack:(Stack *)stack;
+
+@end
+
+@implementation StackArrayView
+
+- (instancetype)initWithStack:(Stack *)stack {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _stack = stack;
+        _mutations = stack->_buffer.mutations;
+        
+    }
+    
+    return self;
+    
+}
+
+- (NSUInteger)count {
+    
+    [self checkForMutation];
+    
+    return _stack->_buffer.count;
+    
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    
+    [self checkForMutation];
+    
+    return [_stack objectAtIndex:index];
+    
+}
+
+- (void)getObjects:(id  _Nonnull __unsafe_unretained [])objects range:(NSRange)range {
+    
+    [self checkForMutation];
+    
+    if (NSMaxRange(range) > _stack->_buffer.count) {
+        
+        [NSException raise:NSRangeException format:@"range %@ beyond bounds for stack of count %lu", NSStringFromRange(range), (unsigned long)_stack->_buffer.count];
+        
+    }
+    
+    memcpy((void *)objects, _stack->_buffer.objects + range.location, range.length * sizeof(id));
+    
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id  _Nullable __unsafe_unretained [])buffer count:(NSUInteger)len {
+    
+    [self checkForMutation];
+    
+    return SQContiguousBufferEnumerate(&_stack->_buffer, state);
+    
+}
+
+- (void)checkForMutation {
+    
+    if (_stack->_buffer.mutations != _mutations) {
+        
+        [NSException raise:NSGenericException format:@"*** Stack <%p> was mutated while it was being read", _stack];
+        
+    }
+    
+}
+
+@end
+
+@interface Stack<ObjectType> () {
+    
+    NSMutableArray<SQChangeObserver *> *_changeObservers;
+    
+    // The SQStackFastPath operations whose methods the class doesn't override
+    uint32_t _inheritedFastPaths;
+    
+    // Storage for the first objects, allocated along with the instance by +allocWithInlineCapacity:
+    const void **_inlineObjects;
+    NSUInteger _inlineCapacity;
+    
+    SQStackMarkRecord *_marks;
+    NSUInteger _markCount;
+    NSUInteger _markCapacity;
+    NSUInteger _markGeneration;
+    
+    // Results for -removeObjectsWithOptions:passingTest:, kept so regular purges don't allocate
+    SQTestResults _testResults;
+    
+}
+
+@property (nonatomic, readonly) NSArray<ObjectType> *internalArray;
 
-@property (nonatomic, copy) NSArray<ObjectType> *internalArray;
+- (instancetype)initWithFirstObject:(id)firstObj arguments:(va_list)args;
 
 @end
 
@@ -70,17 +227,12 @@
 
 + (instancetype)stackWithObjects:(id)firstObj, ... {
     
-    NSArray *objects = @[];
     va_list args;
     va_start(args, firstObj);
+    Stack *stack = [[self alloc] initWithFirstObject:firstObj arguments:args];
+    va_end(args);
     
-    for (id arg = firstObj; arg != nil; arg = va_arg(args, id)) {
-        
-        objects = [objects arrayByAddingObject:arg];
-        
-    }
-    
-    return [self stackWithArray:objects];
+    return stack;
     
 }
 
@@ -96,6 +248,38 @@
     
 }
 
++ (instancetype)stackWithInlineCapacity:(NSUInteger)capacity {
+    
+    return [[self allocWithInlineCapacity:capacity] init];
+    
+}
+
++ (instancetype)allocWithInlineCapacity:(NSUInteger)capacity {
+    
+    Stack *stack = class_createInstance(self, capacity * sizeof(void *));
+    
+    if (stack && capacity > 0) {
+        
+        // The extra bytes sit straight after the instance's ivars
+        stack->_inlineObjects = (const void **)(void *)((uint8_t *)(__bridge void *)stack + class_getInstanceSize(self));
+        stack->_inlineCapacity = capacity;
+        
+    }
+    
+    return stack;
+    
+}
+
+#if SQStackInlineCapacity > 0
+
++ (instancetype)allocWithZone:(struct _NSZone *)zone {
+    
+    return [self allocWithInlineCapacity:SQStackInlineCapacity];
+    
+}
+
+#endif
+
 #pragma mark - Overridden Instance Methods
 
 - (instancetype)init {
@@ -106,9 +290,17 @@
     
 }
 
+- (void)dealloc {
+    
+    SQContiguousBufferDestroy(&_buffer);
+    SQTestResultsDestroy(&_testResults);
+    free(_marks);
+    
+}
+
 - (NSUInteger)hash {
     
-    return self.internalArray.hash;
+    return self.count;
     
 }
 
@@ -154,13 +346,19 @@
 
 - (void)setValue:(id)value forKey:(NSString *)key {
     
-    [self.internalArray setValue:value forKey:key];
+    SQSetValueForKey(self, value, key);
     
 }
 
 - (id)valueForKey:(NSString *)key {
     
-    return [self.internalArray valueForKey:key];
+    if ([key hasPrefix:@"@"]) {
+        
+        return [self.internalArray valueForKey:key];
+        
+    }
+    
+    return SQValuesForKey(self, self.count, key);
     
 }
 
@@ -168,7 +366,14 @@
 
 - (NSUInteger)count {
     
-    return self.internalArray.count;
+    return _buffer.count;
+    
+}
+
+- (NSArray *)internalArray {
+    
+    // A view rather than a copy, so read-only methods that go through NSArray stay as cheap as they'd be on an array
+    return [[StackArrayView alloc] initWithStack:self];
     
 }
 
@@ -188,7 +393,8 @@
 
 - (void)encodeWithCoder:(NSCoder *)aCoder {
     
-    [aCoder encodeObject:self.internalArray forKey:NSStringFromSelector(@selector(internalArray))];
+    // Archive a real array, so it decodes as one
+    [aCoder encodeObject:SQContiguousBufferCopyArray(&_buffer) forKey:NSStringFromSelector(@selector(internalArray))];
     
 }
 
@@ -198,7 +404,7 @@
     
     if (self) {
         
-        _internalArray = [aDecoder decodeObjectOfClass:[NSArray class] forKey:NSStringFromSelector(@selector(internalArray))];
+        SQContiguousBufferAppendArray(&_buffer, [aDecoder decodeObjectOfClass:[NSArray class] forKey:NSStringFromSelector(@selector(internalArray))]);
         
     }
     
@@ -210,8 +416,16 @@
 
 - (id)copyWithZone:(NSZone *)zone {
     
-    Stack *copy = [[[self class] alloc] init];
-    copy->_internalArray = [self.internalArray copyWithZone:zone];
+    Stack *copy = [[[self class] allocWithInlineCapacity:_inlineCapacity] init];
+    SQContiguousBufferReserve(&copy->_buffer, _buffer.count);
+    
+    for (NSUInteger i = 0; i < _buffer.count; i++) {
+        
+        copy->_buffer.objects[i] = CFRetain(_buffer.objects[i]);
+        
+    }
+    
+    copy->_buffer.count = _buffer.count;
     
     return copy;
     
@@ -221,9 +435,7 @@
 
 - (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id  _Nullable __unsafe_unretained [])buffer count:(NSUInteger)len {
 
-    return [self.internalArray countByEnumeratingWithState:state
-                                                   objects:buffer
-                                                     count:len];
+    return SQContiguousBufferEnumerate(&_buffer, state);
     
 }
 
@@ -241,33 +453,62 @@
 
 - (instancetype)initWithObjects:(id)firstObj, ... {
     
-    NSArray *objects = @[];
     va_list args;
     va_start(args, firstObj);
+    self = [self initWithFirstObject:firstObj arguments:args];
+    va_end(args);
+    
+    return self;
     
-    for (id arg = firstObj; arg != nil; arg = va_arg(args, id)) {
+}
+
+- (instancetype)initWithObjects:(id  _Nonnull const __autoreleasing *)objects count:(NSUInteger)cnt {
+    
+    self = [self initWithArray:@[]];
+    
+    if (self) {
         
-        objects = [objects arrayByAddingObject:arg];
+        SQContiguousBufferReserve(&_buffer, cnt);
+        
+        for (NSUInteger i = 0; i < cnt; i++) {
+            
+            _buffer.objects[i] = CFBridgingRetain(objects[i]);
+            
+        }
+        
+        _buffer.count = cnt;
         
     }
     
-    self = [self initWithArray:objects];
-    
     return self;
     
 }
 
-- (instancetype)initWithObjects:(id  _Nonnull const __autoreleasing *)objects count:(NSUInteger)cnt {
+- (instancetype)initWithObjectsNoCopy:(__strong id *)objects count:(NSUInteger)cnt freeWhenDone:(BOOL)freeWhenDone {
     
-    NSArray *objs = @[];
+    self = [self initWithArray:@[]];
     
-    for (int i = 0; i < cnt; i++) {
+    if (self) {
         
-        objs = [objs arrayByAddingObject:objects[i]];
+        // The C array becomes our storage as is, references and all
+        SQContiguousBufferDestroy(&_buffer);
+        SQContiguousBufferInitNoCopy(&_buffer, (const void **)(void *)objects, cnt, freeWhenDone);
         
     }
     
-    self = [self initWithArray:objs];
+    return self;
+    
+}
+
+- (instancetype)initByMovingObjectsFromArray:(NSMutableArray *)array {
+    
+    self = [self initWithArray:array];
+    
+    if (self) {
+        
+        [array removeAllObjects];
+        
+    }
     
     return self;
     
@@ -279,7 +520,16 @@
     
     if (self) {
         
-        self.internalArray = array;
+        if (_inlineCapacity > 0)
+            SQContiguousBufferInitWithInlineStorage(&_buffer, _inlineObjects, _inlineCapacity);
+        else
+            SQContiguousBufferInit(&_buffer, 0);
+        
+        SQContiguousBufferAppendArray(&_buffer, array);
+        
+        static const SEL selectors[] = { @selector(push:), @selector(pop), @selector(peek), @selector(count) };
+        _inheritedFastPaths = SQInheritedMethodMask(object_getClass(self), [Stack class], selectors, 4);
+        [self updateFastPaths];
         
     }
     
@@ -291,40 +541,169 @@
 
 - (void)push:(id)object {
     
-    _internalArray = [self.internalArray arrayByAddingObject:object];
+    NSUInteger previousCount = _buffer.count;
+    SQContiguousBufferAppend(&_buffer, object);
+    [self recordInsertionOfCount:1 previousCount:previousCount];
     
 }
 
 - (void)pushObjects:(NSArray *)objects {
     
-    for (id object in objects) {
-        
-        [self push:object];
-        
-    }
+    NSUInteger previousCount = _buffer.count;
+    SQContiguousBufferAppendArray(&_buffer, objects);
+    [self recordInsertionOfCount:objects.count previousCount:previousCount];
     
 }
 
 - (id)peek {
     
-    return self.internalArray.lastObject;
+    return _buffer.count > 0 ? (__bridge id)_buffer.objects[_buffer.count - 1] : nil;
     
 }
 
 - (id)pop {
     
-    id lastObj = [self peek];
-    _internalArray = [self.internalArray subarrayWithRange:NSMakeRange(0, self.internalArray.count - 1)];
+    NSUInteger previousCount = _buffer.count;
+    id lastObj = SQContiguousBufferRemoveLast(&_buffer);
+    
+    if (!lastObj) {
+        
+        return nil;
+        
+    }
+    
+    if (_markCount > 0) {
+        
+        // Popping below the innermost mark moves it down, so a rollback also removes anything pushed in its place
+        SQStackMarkRecord *mark = &_marks[_markCount - 1];
+        mark->low = MIN(mark->low, _buffer.count);
+        
+    }
+    
+    [self recordRemovalOfCount:1 previousCount:previousCount];
     
     return lastObj;
     
 }
 
+#pragma mark - Marks
+
+- (id<NSObject>)pushMark {
+    
+    if (_markCount == _markCapacity) {
+        
+        _markCapacity = MAX(4, 2 * _markCapacity);
+        _marks = realloc(_marks, _markCapacity * sizeof(SQStackMarkRecord));
+        
+    }
+    
+    SQStackMarkRecord *record = &_marks[_markCount];
+    record->depth = _buffer.count;
+    record->low = _buffer.count;
+    record->generation = ++_markGeneration;
+    
+    SQStackMark *mark = [[SQStackMark alloc] init];
+    mark->_stack = self;
+    mark->_level = _markCount++;
+    mark->_generation = record->generation;
+    [self updateFastPaths];
+    
+    return mark;
+    
+}
+
+- (void)rollbackToMark:(id<NSObject>)mark {
+    
+    NSUInteger depth = [self removeMark:mark];
+    NSUInteger previousCount = _buffer.count;
+    
+    if (depth < previousCount) {
+        
+        SQContiguousBufferTruncate(&_buffer, depth);
+        [self recordRemovalOfCount:previousCount - depth previousCount:previousCount];
+        
+    }
+    
+}
+
+- (void)commitMark:(id<NSObject>)mark {
+    
+    [self removeMark:mark];
+    
+}
+
+#pragma mark - Removing Objects
+
+- (NSUInteger)removeObjectsPassingTest:(BOOL (^)(id _Nonnull, NSUInteger, BOOL * _Nonnull))predicate {
+    
+    return [self removeObjectsWithOptions:0 passingTest:predicate];
+    
+}
+
+- (NSUInteger)removeObjectsWithOptions:(NSEnumerationOptions)opts passingTest:(BOOL (^)(id _Nonnull, NSUInteger, BOOL * _Nonnull))predicate {
+    
+    NSUInteger count = _buffer.count;
+    
+    if (count == 0)
+        return 0;
+    
+    // Test every object before touching the buffer, so the test never sees it half closed up, and one that throws leaves it as it was
+    unsigned long mutations = _buffer.mutations;
+    SQContiguousBuffer *buffer = &_buffer;
+    SQTestResults results = SQTestResultsTake(&_testResults, count);
+    uint8_t *marks = results.bytes;
+    SQEvaluateTest(marks, count, opts, &_buffer.mutations, ^id(NSUInteger index) {
+        
+        return (__bridge id)buffer->objects[index];
+        
+    }, predicate);
+    
+    if (_buffer.mutations != mutations) {
+        
+        SQTestResultsReturn(&_testResults, results);
+        [NSException raise:NSGenericException format:@"*** Stack <%p> was mutated while its objects were being tested", self];
+        
+    }
+    
+    NSUInteger removed = SQContiguousBufferRemoveMarkedObjects(&_buffer, marks);
+    
+    if (removed > 0 && (_changeObservers.count > 0 || _markCount > 0)) {
+        
+        SQEnumerateRemovedRanges(marks, count, ^(NSRange range) {
+            
+            [self recordRemovalOfRange:range];
+            
+        });
+        
+    }
+    
+    SQTestResultsReturn(&_testResults, results);
+    
+    return removed;
+    
+}
+
+- (void)filterUsingPredicate:(NSPredicate *)predicate {
+    
+    [self removeObjectsPassingTest:^BOOL(id obj, NSUInteger idx, BOOL *stop) {
+        
+        return ![predicate evaluateWithObject:obj];
+        
+    }];
+    
+}
+
 #pragma mark - Get Objects
 
 - (id)objectAtIndex:(NSUInteger)index {
     
-    return self.internalArray[index];
+    if (index >= _buffer.count) {
+        
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds for stack of count %lu", (unsigned long)index, (unsigned long)_buffer.count];
+        
+    }
+    
+    return (__bridge id)_buffer.objects[index];
     
 }
 
@@ -468,28 +847,29 @@
 
 - (Stack *)stackByPushing:(id)object {
     
-    Stack *stack = [self copy];
+    // Copy once, straight from our storage, and apply the change to the copy
+    Stack *stack = [[Stack alloc] initWithArray:self.internalArray];
     [stack push:object];
     
-    return [[Stack alloc] initWithArray:stack.internalArray];
+    return stack;
     
 }
 
 - (Stack *)stackByPushingObjects:(NSArray *)objects {
     
-    Stack *stack = [self copy];
+    Stack *stack = [[Stack alloc] initWithArray:self.internalArray];
     [stack pushObjects:objects];
     
-    return [[Stack alloc] initWithArray:stack.internalArray];
+    return stack;
     
 }
 
 - (Stack *)stackByPopping {
     
-    Stack *stack = [self copy];
+    Stack *stack = [[Stack alloc] initWithArray:self.internalArray];
     [stack pop];
     
-    return [[Stack alloc] initWithArray:stack.internalArray];
+    return stack;
     
 }
 
@@ -562,50 +942,55 @@
     if (idx1 == idx2)
         return;
     
-    NSUInteger firstIndex = MIN(idx1, idx2);
-    NSUInteger secondIndex = MAX(idx1, idx2);
+    if (MAX(idx1, idx2) >= _buffer.count) {
+        
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds for stack of count %lu", (unsigned long)MAX(idx1, idx2), (unsigned long)_buffer.count];
+        
+    }
     
-    NSArray *firstSub = [self.internalArray subarrayWithRange:NSMakeRange(0, firstIndex)];
-    id first = self.internalArray[firstIndex];
-    NSUInteger secondLen = secondIndex - firstIndex - 1;
-    NSArray *secondSub = [self.internalArray subarrayWithRange:NSMakeRange(firstIndex + 1, secondLen == -1 ? 0 : secondLen)];
-    id second = self.internalArray[secondIndex];
-    NSUInteger finalLen = self.internalArray.count - secondIndex - 1;
-    NSArray *finalSub = [self.internalArray subarrayWithRange:NSMakeRange(secondIndex + 1, finalLen)];
+    const void *object = _buffer.objects[idx1];
+    _buffer.objects[idx1] = _buffer.objects[idx2];
+    _buffer.objects[idx2] = object;
+    _buffer.mutations++;
     
-    _internalArray = [[[[firstSub arrayByAddingObject:second] arrayByAddingObjectsFromArray:secondSub] arrayByAddingObject:first] arrayByAddingObjectsFromArray:finalSub];
+    [self recordReorder];
     
 }
 
 - (void)sortUsingDescriptors:(NSArray<NSSortDescriptor *> *)sortDescriptors {
     
-    _internalArray = [self.internalArray sortedArrayUsingDescriptors:sortDescriptors];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayUsingDescriptors:sortDescriptors]];
+    [self recordReorder];
     
 }
 
 - (void)sortUsingComparator:(NSComparator)cmptr {
     
-    _internalArray = [self.internalArray sortedArrayUsingComparator:cmptr];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayUsingComparator:cmptr]];
+    [self recordReorder];
     
 }
 
 - (void)sortWithOptions:(NSSortOptions)opts usingComparator:(NSComparator)cmptr {
     
-    _internalArray = [self.internalArray sortedArrayWithOptions:opts
-                                                    usingComparator:cmptr];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayWithOptions:opts
+                                                              usingComparator:cmptr]];
+    [self recordReorder];
     
 }
 
 - (void)sortUsingFunction:(NSInteger (*)(id  _Nonnull __strong, id  _Nonnull __strong, void * _Nonnull))compare context:(void *)context {
     
-    _internalArray = [self.internalArray sortedArrayUsingFunction:compare
-                                                              context:context];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayUsingFunction:compare
+                                                                        context:context]];
+    [self recordReorder];
     
 }
 
 - (void)sortUsingSelector:(SEL)aSelector {
     
-    _internalArray = [self.internalArray sortedArrayUsingSelector:aSelector];
+    [self replaceContentsWithArray:[self.internalArray sortedArrayUsingSelector:aSelector]];
+    [self recordReorder];
     
 }
 
@@ -617,6 +1002,85 @@
     
 }
 
+#pragma mark - Binary Coding
+
+- (BOOL)writeToStream:(NSOutputStream *)stream error:(NSError **)error {
+    
+    SQBinaryEncoder *encoder = [[SQBinaryEncoder alloc] initWithStream:stream];
+    
+    for (id object in self) {
+        
+        if (![encoder encodeObject:object error:error])
+            return NO;
+        
+    }
+    
+    return [encoder finishWithError:error];
+    
+}
+
+- (BOOL)pushObjectsFromStream:(NSInputStream *)stream allowedClasses:(NSSet<Class> *)allowedClasses error:(NSError **)error {
+    
+    SQBinaryDecoder *decoder = [[SQBinaryDecoder alloc] initWithStream:stream allowedClasses:allowedClasses];
+    
+    return [decoder decodeObjectsUsingBlock:^(NSArray *batch) {
+        
+        [self pushObjects:batch];
+        
+    } error:error];
+    
+}
+
+#pragma mark - Key-Value Coding
+
+- (void)int64ValuesForKey:(NSString *)key into:(int64_t *)buffer {
+    
+    SQInt64ValuesForKey(self, key, buffer);
+    
+}
+
+- (void)doubleValuesForKey:(NSString *)key into:(double *)buffer {
+    
+    SQDoubleValuesForKey(self, key, buffer);
+    
+}
+
+#pragma mark - Observing Changes
+
+- (id<NSObject>)addChangeObserverOnQueue:(dispatch_queue_t)queue usingBlock:(void (^)(NSArray<StackQueueChange *> * _Nonnull))block {
+    
+    SQChangeObserver *observer = [[SQChangeObserver alloc] initWithQueue:queue
+                                                             removalEdge:SQChangeObserverRemovalEdgeBack
+                                                                   block:block];
+    
+    if (!_changeObservers) {
+        
+        _changeObservers = [NSMutableArray array];
+        
+    }
+    
+    [_changeObservers addObject:observer];
+    [self updateFastPaths];
+    
+    return observer;
+    
+}
+
+- (void)removeChangeObserver:(id<NSObject>)observer {
+    
+    [(SQChangeObserver *)observer invalidate];
+    [_changeObservers removeObjectIdenticalTo:observer];
+    
+    if (_changeObservers.count == 0) {
+        
+        _changeObservers = nil;
+        
+    }
+    
+    [self updateFastPaths];
+    
+}
+
 #pragma mark - Contents Observation
 
 - (void)addObserver:(NSObject *)observer toObjectsAtIndexes:(NSIndexSet *)indexes forKeyPath:(NSString *)keyPath options:(NSKeyValueObservingOptions)options context:(void *)context {
@@ -657,4 +1121,144 @@
     
 }
 
+#pragma mark - Private Instance Methods
+
+/**
+ Remove a mark, and every mark nested inside it
+ 
+ @param token The mark's token
+ @return The count to roll back to for the mark
+ */
+- (NSUInteger)removeMark:(id<NSObject>)token {
+    
+    SQStackMark *mark = (SQStackMark *)token;
+    
+    // Generations are only unique within a stack, so check the mark was made here first
+    if (![mark isKindOfClass:[SQStackMark class]] || mark->_stack != self || mark->_level >= _markCount || _marks[mark->_level].generation != mark->_generation) {
+        
+        [NSException raise:NSInvalidArgumentException format:@"%@ is not a live mark on this stack", token];
+        
+    }
+    
+    // Fold the low water marks of the nested marks we're discarding into this one
+    NSUInteger low = _marks[mark->_level].low;
+    
+    for (NSUInteger level = mark->_level + 1; level < _markCount; level++) {
+        
+        low = MIN(low, _marks[level].low);
+        
+    }
+    
+    _markCount = mark->_level;
+    
+    // The mark that encloses this one was outer while we were innermost, so it hasn't seen our pops
+    if (_markCount > 0) {
+        
+        SQStackMarkRecord *outer = &_marks[_markCount - 1];
+        outer->low = MIN(outer->low, MIN(low, _buffer.count));
+        
+    }
+    
+    [self updateFastPaths];
+    
+    return low;
+    
+}
+
+/**
+ Recompute which operations the inline functions may perform directly. Push and pop must go through their methods while there are change observers to notify, and pop must while there are marks to move down.
+ */
+- (void)updateFastPaths {
+    
+    uint32_t fastPaths = _inheritedFastPaths;
+    
+    if (_changeObservers.count > 0) {
+        
+        fastPaths &= ~(uint32_t)(SQStackFastPathPush | SQStackFastPathPop);
+        
+    }
+    
+    if (_markCount > 0) {
+        
+        fastPaths &= ~(uint32_t)SQStackFastPathPop;
+        
+    }
+    
+    _fastPaths = fastPaths;
+    
+}
+
+- (instancetype)initWithFirstObject:(id)firstObj arguments:(va_list)args {
+    
+    self = [self initWithArray:@[]];
+    
+    if (self) {
+        
+        for (id arg = firstObj; arg != nil; arg = va_arg(args, id)) {
+            
+            SQContiguousBufferAppend(&_buffer, arg);
+            
+        }
+        
+    }
+    
+    return self;
+    
+}
+
+- (void)replaceContentsWithArray:(NSArray *)array {
+    
+    SQContiguousBufferDestroy(&_buffer);
+    SQContiguousBufferAppendArray(&_buffer, array);
+    
+}
+
+- (void)recordInsertionOfCount:(NSUInteger)count previousCount:(NSUInteger)previousCount {
+    
+    for (SQChangeObserver *observer in _changeObservers) {
+        
+        [observer recordInsertionOfCount:count previousCount:previousCount];
+        
+    }
+    
+}
+
+- (void)recordRemovalOfCount:(NSUInteger)count previousCount:(NSUInteger)previousCount {
+    
+    for (SQChangeObserver *observer in _changeObservers) {
+        
+        [observer recordRemovalOfCount:count previousCount:previousCount];
+        
+    }
+    
+}
+
+- (void)recordRemovalOfRange:(NSRange)range {
+    
+    // Marks above the range move down with the objects above it, and marks inside it move down to where it was
+    for (NSUInteger level = 0; level < _markCount; level++) {
+        
+        _marks[level].depth = SQStackPositionAfterRemoval(_marks[level].depth, range);
+        _marks[level].low = SQStackPositionAfterRemoval(_marks[level].low, range);
+        
+    }
+    
+    for (SQChangeObserver *observer in _changeObservers) {
+        
+        [observer recordRemovalOfRange:range];
+        
+    }
+    
+}
+
+- (void)recordReorder {
+    
+    for (SQChangeObserver *observer in _changeObservers) {
+        
+        [observer recordReorderOfCount:self.count];
+        
+    }
+    
+}
+
 @end
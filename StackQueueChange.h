@@ -0,0 +1,63 @@
+//
+//  StackQueueChange.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The kinds of change a stack or a queue can report
+ */
+typedef NS_ENUM(NSUInteger, StackQueueChangeKind) {
+
+    /**
+     Objects were inserted (enqueued or pushed) at the given range
+     */
+    StackQueueChangeKindInsertion,
+
+    /**
+     Objects were removed (dequeued, popped or filtered out) from the given range
+     */
+    StackQueueChangeKindRemoval,
+
+    /**
+     The objects in the given range were reordered (sorted or exchanged)
+     */
+    StackQueueChangeKindReorder
+
+};
+
+/**
+ A coalesced change to a stack or a queue
+
+ @discussion Changes are delivered in batches, and must be applied in order: the range of each change is expressed in terms of the contents of the container after every change before it in the batch has been applied.
+ */
+@interface StackQueueChange : NSObject
+
+/**
+ Create a change
+
+ @param kind The kind of change
+ @param range The affected range
+ @return The change
+ */
++ (instancetype)changeWithKind:(StackQueueChangeKind)kind range:(NSRange)range;
+
+/**
+ The kind of change
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) StackQueueChangeKind kind;
+
+/**
+ The range of the container affected by the change
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSRange range;
+
+@end
+
+NS_ASSUME_NONNULL_END
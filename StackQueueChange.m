@@ -0,0 +1,35 @@
+//
+//  StackQueueChange.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "StackQueueChange.h"
+
+@implementation StackQueueChange
+
+#pragma mark - Public Class Methods
+
++ (instancetype)changeWithKind:(StackQueueChangeKind)kind range:(NSRange)range {
+    
+    StackQueueChange *change = [[self alloc] init];
+    change->_kind = kind;
+    change->_range = range;
+    
+    return change;
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (NSString *)description {
+    
+    static NSString * const names[] = { @"insertion", @"removal", @"reorder" };
+    
+    return [NSString stringWithFormat:@"<%@ %@ %@>", NSStringFromClass([self class]), names[self.kind], NSStringFromRange(self.range)];
+    
+}
+
+@end
@@ -0,0 +1,304 @@
+//
+//  ConcurrentQueueTests.m
+//  StackQueueTests
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import XCTest;
+
+#import "ConcurrentQueue.h"
+#import "Queue.h"
+
+#import <os/lock.h>
+#import <stdatomic.h>
+
+static const NSUInteger SQProducerCount = 8;
+static const NSUInteger SQConsumerCount = 8;
+static const NSUInteger SQObjectsPerProducer = 100000;
+
+/**
+ A Queue behind a single lock, the baseline a ConcurrentQueue replaces
+ */
+@interface SQLockedQueue : NSObject<Queueing>
+
+@end
+
+@implementation SQLockedQueue {
+    
+    os_unfair_lock _lock;
+    Queue *_queue;
+    
+}
+
+- (instancetype)init {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _queue = [Queue queue];
+        
+    }
+    
+    return self;
+    
+}
+
+- (void)enqueue:(id)object {
+    
+    os_unfair_lock_lock(&_lock);
+    [_queue enqueue:object];
+    os_unfair_lock_unlock(&_lock);
+    
+}
+
+- (void)enqueueObjects:(NSArray *)objects {
+    
+    os_unfair_lock_lock(&_lock);
+    [_queue enqueueObjects:objects];
+    os_unfair_lock_unlock(&_lock);
+    
+}
+
+- (id)peek {
+    
+    os_unfair_lock_lock(&_lock);
+    id object = [_queue peek];
+    os_unfair_lock_unlock(&_lock);
+    
+    return object;
+    
+}
+
+- (id)dequeue {
+    
+    os_unfair_lock_lock(&_lock);
+    id object = [_queue dequeue];
+    os_unfair_lock_unlock(&_lock);
+    
+    return object;
+    
+}
+
+- (NSUInteger)count {
+    
+    os_unfair_lock_lock(&_lock);
+    NSUInteger count = _queue.count;
+    os_unfair_lock_unlock(&_lock);
+    
+    return count;
+    
+}
+
+@end
+
+@interface ConcurrentQueueTests : XCTestCase
+
+@end
+
+@implementation ConcurrentQueueTests {
+    
+    // The objects each producer enqueues, in order. Each is (producer << 32) | sequence number.
+    NSArray<NSArray<NSNumber *> *> *_inputs;
+    
+}
+
+- (void)setUp {
+    
+    [super setUp];
+    
+    NSMutableArray<NSArray<NSNumber *> *> *inputs = [NSMutableArray arrayWithCapacity:SQProducerCount];
+    
+    for (NSUInteger producer = 0; producer < SQProducerCount; producer++) {
+        
+        NSMutableArray<NSNumber *> *objects = [NSMutableArray arrayWithCapacity:SQObjectsPerProducer];
+        
+        for (NSUInteger i = 0; i < SQObjectsPerProducer; i++) {
+            
+            [objects addObject:@(((uint64_t)producer << 32) | i)];
+            
+        }
+        
+        [inputs addObject:objects];
+        
+    }
+    
+    _inputs = inputs;
+    
+}
+
+#pragma mark - Correctness
+
+- (void)testFIFOOnOneThread {
+    
+    ConcurrentQueue<NSNumber *> *queue = [ConcurrentQueue queue];
+    NSUInteger count = 1000;
+    
+    for (NSUInteger i = 0; i < count; i++) {
+        
+        [queue enqueue:@(i)];
+        
+    }
+    
+    XCTAssertEqual(queue.count, count);
+    XCTAssertEqualObjects(queue.peek, @0);
+    
+    for (NSUInteger i = 0; i < count; i++) {
+        
+        XCTAssertEqualObjects([queue dequeue], @(i));
+        
+    }
+    
+    XCTAssertNil([queue dequeue]);
+    XCTAssertEqual(queue.count, 0);
+    
+}
+
+- (void)testEnqueueObjectsKeepsOrder {
+    
+    ConcurrentQueue<NSNumber *> *queue = [ConcurrentQueue queueWithArray:@[@0, @1]];
+    [queue enqueueObjects:@[@2, @3, @4]];
+    
+    for (NSUInteger i = 0; i < 5; i++) {
+        
+        XCTAssertEqualObjects([queue dequeue], @(i));
+        
+    }
+    
+}
+
+- (void)testEveryObjectIsDequeuedOnceInProducerOrder {
+    
+    NSArray<NSArray<NSNumber *> *> *outputs = [self runProducersAndConsumersOnQueue:[ConcurrentQueue queue]];
+    NSMutableSet<NSNumber *> *seen = [NSMutableSet setWithCapacity:SQProducerCount * SQObjectsPerProducer];
+    
+    for (NSArray<NSNumber *> *output in outputs) {
+        
+        // Each consumer must see each producer's objects in the order they were enqueued
+        int64_t last[SQProducerCount];
+        
+        for (NSUInteger producer = 0; producer < SQProducerCount; producer++) {
+            
+            last[producer] = -1;
+            
+        }
+        
+        for (NSNumber *object in output) {
+            
+            uint64_t value = object.unsignedLongLongValue;
+            NSUInteger producer = (NSUInteger)(value >> 32);
+            int64_t sequence = (int64_t)(value & UINT32_MAX);
+            
+            XCTAssertGreaterThan(sequence, last[producer]);
+            last[producer] = sequence;
+            
+            [seen addObject:object];
+            
+        }
+        
+    }
+    
+    XCTAssertEqual(seen.count, SQProducerCount * SQObjectsPerProducer);
+    
+}
+
+#pragma mark - Benchmarks
+
+- (void)testPerformanceEightProducersEightConsumers {
+    
+    [self measureBlock:^{
+        
+        [self runProducersAndConsumersOnQueue:[ConcurrentQueue queue]];
+        
+    }];
+    
+}
+
+- (void)testPerformanceEightProducersEightConsumersSingleLock {
+    
+    [self measureBlock:^{
+        
+        [self runProducersAndConsumersOnQueue:[[SQLockedQueue alloc] init]];
+        
+    }];
+    
+}
+
+#pragma mark - Private Instance Methods
+
+/**
+ Enqueue every producer's objects from its own thread while the consumers drain the queue from theirs
+
+ @param queue The queue
+ @return The objects each consumer dequeued, in order
+ */
+- (NSArray<NSArray<NSNumber *> *> *)runProducersAndConsumersOnQueue:(id<Queueing>)queue {
+    
+    NSUInteger total = SQProducerCount * SQObjectsPerProducer;
+    __block _Atomic(NSUInteger) consumed = 0;
+    NSMutableArray<NSMutableArray<NSNumber *> *> *outputs = [NSMutableArray arrayWithCapacity:SQConsumerCount];
+    
+    for (NSUInteger consumer = 0; consumer < SQConsumerCount; consumer++) {
+        
+        [outputs addObject:[NSMutableArray arrayWithCapacity:total / SQConsumerCount]];
+        
+    }
+    
+    // Dedicated threads rather than dispatch, whose pool may not start the producers while spinning consumers hold every worker
+    dispatch_group_t group = dispatch_group_create();
+    
+    for (NSUInteger producer = 0; producer < SQProducerCount; producer++) {
+        
+        NSArray<NSNumber *> *input = _inputs[producer];
+        dispatch_group_enter(group);
+        
+        [NSThread detachNewThreadWithBlock:^{
+            
+            for (NSNumber *object in input) {
+                
+                [queue enqueue:object];
+                
+            }
+            
+            dispatch_group_leave(group);
+            
+        }];
+        
+    }
+    
+    for (NSUInteger consumer = 0; consumer < SQConsumerCount; consumer++) {
+        
+        NSMutableArray<NSNumber *> *output = outputs[consumer];
+        dispatch_group_enter(group);
+        
+        [NSThread detachNewThreadWithBlock:^{
+            
+            while (atomic_load_explicit(&consumed, memory_order_relaxed) < total) {
+                
+                NSNumber *object = [queue dequeue];
+                
+                if (object) {
+                    
+                    [output addObject:object];
+                    atomic_fetch_add_explicit(&consumed, 1, memory_order_relaxed);
+                    
+                }
+                
+            }
+            
+            dispatch_group_leave(group);
+            
+        }];
+        
+    }
+    
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    return outputs;
+    
+}
+
+@end
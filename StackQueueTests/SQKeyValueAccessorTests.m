@@ -0,0 +1,232 @@
+//
+//  SQKeyValueAccessorTests.m
+//  StackQueueTests
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import XCTest;
+
+#import "Queue.h"
+#import "Stack.h"
+
+#import <objc/runtime.h>
+
+static const NSUInteger SQBenchmarkObjectCount = 100000;
+
+@interface SQTestRecord : NSObject
+
+@property (nonatomic) int64_t identifier;
+@property (nonatomic) double score;
+@property (nonatomic, copy) NSString *name;
+
+@end
+
+@implementation SQTestRecord
+
+@end
+
+/**
+ A class with ordered collection accessors for `items`, which KVC answers with a proxy array instead of reading the ivar
+ */
+@interface SQTestCollectionRecord : NSObject {
+    
+    NSArray *_items;
+    
+}
+
+@end
+
+@implementation SQTestCollectionRecord
+
+- (NSUInteger)countOfItems {
+    
+    return 2;
+    
+}
+
+- (id)objectInItemsAtIndex:(NSUInteger)index {
+    
+    return @(index);
+    
+}
+
+@end
+
+@interface SQKeyValueAccessorTests : XCTestCase
+
+@end
+
+@implementation SQKeyValueAccessorTests {
+    
+    NSArray<SQTestRecord *> *_records;
+    
+}
+
+- (void)setUp {
+    
+    [super setUp];
+    
+    NSMutableArray<SQTestRecord *> *records = [NSMutableArray arrayWithCapacity:SQBenchmarkObjectCount];
+    
+    for (NSUInteger i = 0; i < SQBenchmarkObjectCount; i++) {
+        
+        SQTestRecord *record = [[SQTestRecord alloc] init];
+        record.identifier = (int64_t)i;
+        record.score = i / 2.0;
+        record.name = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+        [records addObject:record];
+        
+    }
+    
+    _records = records;
+    
+}
+
+#pragma mark - Correctness
+
+- (void)testValueForKeyMatchesFoundation {
+    
+    Queue *queue = [Queue queueWithArray:_records];
+    Stack *stack = [Stack stackWithArray:_records];
+    
+    XCTAssertEqualObjects([queue valueForKey:@"identifier"], [_records valueForKey:@"identifier"]);
+    XCTAssertEqualObjects([queue valueForKey:@"score"], [_records valueForKey:@"score"]);
+    XCTAssertEqualObjects([queue valueForKey:@"name"], [_records valueForKey:@"name"]);
+    XCTAssertEqualObjects([stack valueForKey:@"identifier"], [_records valueForKey:@"identifier"]);
+    
+}
+
+- (void)testSetValueForKey {
+    
+    Queue *queue = [Queue queueWithArray:_records];
+    [queue setValue:@7 forKey:@"identifier"];
+    [queue setValue:@"seven" forKey:@"name"];
+    
+    for (SQTestRecord *record in _records) {
+        
+        XCTAssertEqual(record.identifier, 7);
+        XCTAssertEqualObjects(record.name, @"seven");
+        
+    }
+    
+}
+
+- (void)testTypedColumns {
+    
+    Queue *queue = [Queue queueWithArray:_records];
+    int64_t *identifiers = malloc(queue.count * sizeof(int64_t));
+    double *scores = malloc(queue.count * sizeof(double));
+    
+    [queue int64ValuesForKey:@"identifier" into:identifiers];
+    [queue doubleValuesForKey:@"score" into:scores];
+    
+    for (NSUInteger i = 0; i < queue.count; i++) {
+        
+        XCTAssertEqual(identifiers[i], (int64_t)i);
+        XCTAssertEqual(scores[i], i / 2.0);
+        
+    }
+    
+    free(identifiers);
+    free(scores);
+    
+}
+
+- (void)testReplacedGetterIsPickedUp {
+    
+    Queue *queue = [Queue queueWithObject:_records.firstObject];
+    XCTAssertEqualObjects([queue valueForKey:@"score"], @[@0.0]);
+    
+    Method method = class_getInstanceMethod([SQTestRecord class], @selector(score));
+    IMP original = method_setImplementation(method, imp_implementationWithBlock(^double(id record) {
+        
+        return 42;
+        
+    }));
+    
+    XCTAssertEqualObjects([queue valueForKey:@"score"], @[@42.0]);
+    
+    method_setImplementation(method, original);
+    
+    XCTAssertEqualObjects([queue valueForKey:@"score"], @[@0.0]);
+    
+}
+
+- (void)testCollectionAccessorsAreLeftToKeyValueCoding {
+    
+    SQTestCollectionRecord *record = [[SQTestCollectionRecord alloc] init];
+    Queue *queue = [Queue queueWithObject:record];
+    
+    XCTAssertEqualObjects([queue valueForKey:@"items"], @[[record valueForKey:@"items"]]);
+    XCTAssertEqualObjects([queue valueForKey:@"items"], (@[@[@0, @1]]));
+    
+}
+
+#pragma mark - Benchmarks
+
+- (void)testPerformanceFoundationValueForKey {
+    
+    NSArray<SQTestRecord *> *records = _records;
+    
+    [self measureBlock:^{
+        
+        [records valueForKey:@"identifier"];
+        
+    }];
+    
+}
+
+- (void)testPerformanceQueueValueForKey {
+    
+    Queue *queue = [Queue queueWithArray:_records];
+    
+    [self measureBlock:^{
+        
+        [queue valueForKey:@"identifier"];
+        
+    }];
+    
+}
+
+- (void)testPerformanceQueueInt64Column {
+    
+    Queue *queue = [Queue queueWithArray:_records];
+    int64_t *identifiers = malloc(queue.count * sizeof(int64_t));
+    
+    [self measureBlock:^{
+        
+        [queue int64ValuesForKey:@"identifier" into:identifiers];
+        
+    }];
+    
+    free(identifiers);
+    
+}
+
+- (void)testPerformanceFoundationSetValueForKey {
+    
+    NSArray<SQTestRecord *> *records = _records;
+    
+    [self measureBlock:^{
+        
+        [records setValue:@7 forKey:@"identifier"];
+        
+    }];
+    
+}
+
+- (void)testPerformanceStackSetValueForKey {
+    
+    Stack *stack = [Stack stackWithArray:_records];
+    
+    [self measureBlock:^{
+        
+        [stack setValue:@7 forKey:@"identifier"];
+        
+    }];
+    
+}
+
+@end
@@ -0,0 +1,135 @@
+//
+//  UniqueQueue.h
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+@import Foundation;
+
+/**
+ What a UniqueQueue does when an object equal to one already in the queue is enqueued
+ */
+typedef NS_ENUM(NSUInteger, UniqueQueueDuplicatePolicy) {
+
+    /**
+     The duplicate is dropped, and the object already in the queue keeps its place
+     */
+    UniqueQueueDuplicatePolicyIgnore,
+
+    /**
+     The object already in the queue is moved to the back, as if it had just been enqueued
+     */
+    UniqueQueueDuplicatePolicyMoveToBack
+
+};
+
+/**
+ A FIFO Queue in Objective-C that never holds two equal objects
+ 
+ @discussion The queue keeps a hash table of its contents in step with its order, so duplicates are found in O(1) instead of by searching the queue. Objects are matched with -isEqual: and -hash. Moving an object to the back, or removing it, doesn't search the queue either: the hash table records which of the object's places in the queue is current, and places that aren't are skipped when they reach the front, and swept out in bulk if they ever outnumber the objects. Every operation is O(1) amortized.
+ */
+@interface UniqueQueue<__covariant ObjectType> : NSObject<NSFastEnumeration>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @name Factory Methods
+ */
+
+/**
+ Create an empty queue that ignores duplicates
+ 
+ @return The queue
+ */
++ (instancetype)queue;
+
+/**
+ Create an empty queue
+ 
+ @param policy What to do when an object that's already in the queue is enqueued
+ @return The queue
+ */
++ (instancetype)queueWithDuplicatePolicy:(UniqueQueueDuplicatePolicy)policy;
+
+/**
+ @name Initializers
+ */
+
+/**
+ Create an empty queue
+ 
+ @param policy What to do when an object that's already in the queue is enqueued
+ @return The queue
+ */
+- (instancetype)initWithDuplicatePolicy:(UniqueQueueDuplicatePolicy)policy NS_DESIGNATED_INITIALIZER;
+
+/**
+ @name Enqueue, Peek, Dequeue
+ */
+
+/**
+ Enqueue an object, unless an equal object is already in the queue, in O(1)
+ 
+ @param object The object
+ @return YES if the object was added, NO if it was a duplicate
+ */
+- (BOOL)enqueue:(ObjectType)object;
+
+/**
+ Enqueue objects, in order, skipping duplicates
+ 
+ @param objects The objects
+ @return The number of objects that were added
+ */
+- (NSUInteger)enqueueObjects:(NSArray<ObjectType> *)objects;
+
+/**
+ View the item at the front of the queue, without changing the queue, so it's safe to call while enumerating
+ 
+ @discussion Stale records left at the front by removed objects are skipped over rather than discarded, so peeking repeatedly without dequeuing costs O(stale records at the front) each time. They're discarded by the next dequeue.
+ @return The item at the front of the queue
+ */
+- (nullable ObjectType)peek;
+
+/**
+ Dequeue an item from the front of the queue, in O(1) amortized. An equal object can be enqueued again afterwards.
+ 
+ @return The item
+ */
+- (nullable ObjectType)dequeue;
+
+/**
+ @name Content Checking
+ */
+
+/**
+ Check whether an equal object is in the queue, in O(1)
+ 
+ @param object The object
+ @return YES if an equal object is in the queue, otherwise NO.
+ */
+- (BOOL)containsObject:(ObjectType)object;
+
+/**
+ Remove an object from wherever it is in the queue, in O(1)
+ 
+ @param object The object
+ @return YES if an equal object was in the queue, otherwise NO.
+ */
+- (BOOL)removeObject:(ObjectType)object;
+
+/**
+ What the queue does when an object that's already in it is enqueued
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) UniqueQueueDuplicatePolicy duplicatePolicy;
+
+/**
+ The number of items in the queue
+ */
+@property (NS_NONATOMIC_IOSONLY, readonly) NSUInteger count;
+
+NS_ASSUME_NONNULL_END
+
+@end
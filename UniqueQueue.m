@@ -0,0 +1,350 @@
+//
+//  UniqueQueue.m
+//  StackQueue
+//
+//  Created by agent on 10/18/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "UniqueQueue.h"
+
+/**
+ One of an object's places in the queue. It's current if the hash table maps the object to the same generation.
+ */
+typedef struct SQUniqueQueueRecord {
+    
+    const void *object;
+    uintptr_t generation;
+    
+} SQUniqueQueueRecord;
+
+@implementation UniqueQueue {
+    
+    UniqueQueueDuplicatePolicy _duplicatePolicy;
+    
+    // Places in the queue, oldest first, in a ring. Each retains its object.
+    SQUniqueQueueRecord *_records;
+    NSUInteger _head;
+    NSUInteger _recordCount;
+    NSUInteger _recordCapacity;
+    
+    // The number of records that are no longer current
+    NSUInteger _staleCount;
+    
+    // Object -> the generation of its current record, matched by equality
+    CFMutableDictionaryRef _generations;
+    uintptr_t _nextGeneration;
+    
+    unsigned long _mutations;
+    
+}
+
+#pragma mark - Public Class Methods
+
++ (instancetype)queue {
+    
+    return [[self alloc] init];
+    
+}
+
++ (instancetype)queueWithDuplicatePolicy:(UniqueQueueDuplicatePolicy)policy {
+    
+    return [[self alloc] initWithDuplicatePolicy:policy];
+    
+}
+
+#pragma mark - Overridden Instance Methods
+
+- (instancetype)init {
+    
+    self = [self initWithDuplicatePolicy:UniqueQueueDuplicatePolicyIgnore];
+    
+    return self;
+    
+}
+
+- (void)dealloc {
+    
+    for (NSUInteger i = 0; i < _recordCount; i++) {
+        
+        CFRelease([self recordAtIndex:i]->object);
+        
+    }
+    
+    free(_records);
+    CFRelease(_generations);
+    
+}
+
+- (NSString *)description {
+    
+    return [NSString stringWithFormat:@"<%@: %p; count = %lu>", NSStringFromClass([self class]), self, (unsigned long)self.count];
+    
+}
+
+#pragma mark - NSFastEnumeration
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id  _Nullable __unsafe_unretained [])buffer count:(NSUInteger)len {
+    
+    if (state->state == 0) {
+        
+        state->mutationsPtr = &_mutations;
+        
+    }
+    
+    // Hand out current records only, skipping the rest, in batches that fit the caller's buffer
+    NSUInteger index = state->state;
+    NSUInteger filled = 0;
+    
+    while (index < _recordCount && filled < len) {
+        
+        SQUniqueQueueRecord *record = [self recordAtIndex:index++];
+        
+        if ([self isCurrent:record]) {
+            
+            buffer[filled++] = (__bridge id)record->object;
+            
+        }
+        
+    }
+    
+    state->state = index;
+    state->itemsPtr = buffer;
+    
+    return filled;
+    
+}
+
+#pragma mark - Property Access Methods
+
+- (UniqueQueueDuplicatePolicy)duplicatePolicy {
+    
+    return _duplicatePolicy;
+    
+}
+
+- (NSUInteger)count {
+    
+    return (NSUInteger)CFDictionaryGetCount(_generations);
+    
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithDuplicatePolicy:(UniqueQueueDuplicatePolicy)policy {
+    
+    self = [super init];
+    
+    if (self) {
+        
+        _duplicatePolicy = policy;
+        _generations = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &kCFTypeDictionaryKeyCallBacks, NULL);
+        
+    }
+    
+    return self;
+    
+}
+
+#pragma mark - Enqueue Peek Dequeue
+
+- (BOOL)enqueue:(id)object {
+    
+    const void *key = (__bridge const void *)object;
+    
+    if (CFDictionaryContainsKey(_generations, key)) {
+        
+        if (_duplicatePolicy == UniqueQueueDuplicatePolicyMoveToBack) {
+            
+            // Leave the old record where it is, and let it go stale
+            _staleCount++;
+            [self appendRecordForObject:object];
+            
+        }
+        
+        return NO;
+        
+    }
+    
+    [self appendRecordForObject:object];
+    
+    return YES;
+    
+}
+
+- (NSUInteger)enqueueObjects:(NSArray *)objects {
+    
+    NSUInteger added = 0;
+    
+    for (id object in objects) {
+        
+        added += [self enqueue:object] ? 1 : 0;
+        
+    }
+    
+    return added;
+    
+}
+
+- (id)peek {
+    
+    // Skip over stale records without removing them, so peeking doesn't count as a mutation during enumeration
+    for (NSUInteger i = 0; i < _recordCount; i++) {
+        
+        SQUniqueQueueRecord *record = [self recordAtIndex:i];
+        
+        if ([self isCurrent:record])
+            return (__bridge id)record->object;
+        
+    }
+    
+    return nil;
+    
+}
+
+- (id)dequeue {
+    
+    [self discardStaleRecordsAtFront];
+    
+    if (_recordCount == 0)
+        return nil;
+    
+    SQUniqueQueueRecord record = [self removeFirstRecord];
+    CFDictionaryRemoveValue(_generations, record.object);
+    
+    return CFBridgingRelease(record.object);
+    
+}
+
+#pragma mark - Content Checking
+
+- (BOOL)containsObject:(id)object {
+    
+    return CFDictionaryContainsKey(_generations, (__bridge const void *)object);
+    
+}
+
+- (BOOL)removeObject:(id)object {
+    
+    const void *key = (__bridge const void *)object;
+    
+    if (!CFDictionaryContainsKey(_generations, key))
+        return NO;
+    
+    // The record stays in the queue, but nothing maps to it any more
+    CFDictionaryRemoveValue(_generations, key);
+    _staleCount++;
+    _mutations++;
+    
+    [self sweepIfMostlyStale];
+    
+    return YES;
+    
+}
+
+#pragma mark - Private Instance Methods
+
+- (SQUniqueQueueRecord *)recordAtIndex:(NSUInteger)index {
+    
+    return &_records[(_head + index) & (_recordCapacity - 1)];
+    
+}
+
+- (BOOL)isCurrent:(SQUniqueQueueRecord *)record {
+    
+    if (_staleCount == 0)
+        return YES;
+    
+    const void *generation;
+    
+    return CFDictionaryGetValueIfPresent(_generations, record->object, &generation) && (uintptr_t)generation == record->generation;
+    
+}
+
+- (void)appendRecordForObject:(id)object {
+    
+    if (_recordCount == _recordCapacity) {
+        
+        // Grow the ring, unwrapping it so the oldest record is first
+        NSUInteger capacity = MAX(16, 2 * _recordCapacity);
+        SQUniqueQueueRecord *records = malloc(capacity * sizeof(SQUniqueQueueRecord));
+        
+        for (NSUInteger i = 0; i < _recordCount; i++) {
+            
+            records[i] = *[self recordAtIndex:i];
+            
+        }
+        
+        free(_records);
+        _records = records;
+        _recordCapacity = capacity;
+        _head = 0;
+        
+    }
+    
+    uintptr_t generation = _nextGeneration++;
+    SQUniqueQueueRecord *record = [self recordAtIndex:_recordCount++];
+    record->object = CFBridgingRetain(object);
+    record->generation = generation;
+    
+    CFDictionarySetValue(_generations, record->object, (const void *)generation);
+    _mutations++;
+    
+    [self sweepIfMostlyStale];
+    
+}
+
+- (SQUniqueQueueRecord)removeFirstRecord {
+    
+    SQUniqueQueueRecord record = _records[_head];
+    _head = (_head + 1) & (_recordCapacity - 1);
+    _recordCount--;
+    _mutations++;
+    
+    return record;
+    
+}
+
+- (void)discardStaleRecordsAtFront {
+    
+    while (_staleCount > 0 && _recordCount > 0 && ![self isCurrent:&_records[_head]]) {
+        
+        CFRelease([self removeFirstRecord].object);
+        _staleCount--;
+        
+    }
+    
+}
+
+/**
+ Sweep out every stale record in one pass, once they outnumber the current ones, so the ring never grows past twice the queue
+ */
+- (void)sweepIfMostlyStale {
+    
+    if (_staleCount < 64 || _staleCount <= _recordCount - _staleCount)
+        return;
+    
+    NSUInteger kept = 0;
+    
+    for (NSUInteger i = 0; i < _recordCount; i++) {
+        
+        SQUniqueQueueRecord record = *[self recordAtIndex:i];
+        
+        if ([self isCurrent:&record]) {
+            
+            *[self recordAtIndex:kept++] = record;
+            
+        } else {
+            
+            CFRelease(record.object);
+            
+        }
+        
+    }
+    
+    _recordCount = kept;
+    _staleCount = 0;
+    
+}
+
+@end